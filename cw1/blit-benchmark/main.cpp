@@ -3,8 +3,11 @@
 #include <algorithm>
 
 #include <cassert>
+#include <cstring>
 
+#include "../draw2d/fill.hpp"
 #include "../draw2d/image.hpp"
+#include "../draw2d/storage.hpp"
 #include "../draw2d/draw-ex.hpp"
 #include "../draw2d/surface-ex.hpp"
 
@@ -95,6 +98,90 @@ namespace
 		aState.SetBytesProcessed( 2*maxBlitX*maxBlitY*4 * aState.iterations() );
 	}
 
+	// Surface::clear() (method 0) versus a plain memset() of the surface
+	// (method 1), which is what clear() used to do. Reports the bytes written.
+	void surface_clear_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+		auto const method = aState.range(2);
+
+		SurfaceEx surface( width, height );
+		surface.clear();
+
+		auto const bytes = std::size_t(width) * height * 4;
+		auto const pitch = surface_pitch( surface );
+
+		for( auto _ : aState )
+		{
+			if( 0 == method )
+				surface.clear();
+			else
+				std::memset( surface.get_surface_ptr(), 0, pitch * height );
+
+			benchmark::ClobberMemory(); 
+		}
+
+		aState.SetBytesProcessed( std::int64_t(bytes) * aState.iterations() );
+	}
+
+	void surface_fill_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+
+		SurfaceEx surface( width, height );
+		surface.clear();
+
+		for( auto _ : aState )
+		{
+			surface.fill( { 40, 80, 120 } );
+
+			benchmark::ClobberMemory(); 
+		}
+
+		aState.SetBytesProcessed( std::int64_t(width) * height * 4 * aState.iterations() );
+	}
+	// Full-surface passes with different kinds of storage (range 2, see
+	// SurfaceStorage); the label shows the storage that was actually used.
+	// Pass 0 clears the surface, pass 1 fills every 16th column, which
+	// touches a different page in each row.
+	void surface_storage_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+		auto const pass = aState.range(3);
+
+		SurfaceStorage const previous = surface_storage_preference();
+		set_surface_storage_preference( SurfaceStorage(aState.range(2)) );
+
+		SurfaceEx surface( width, height );
+		surface.clear();
+
+		set_surface_storage_preference( previous );
+
+		std::uint32_t const rgbx = pack_rgbx( { 40, 80, 120 } );
+		std::ptrdiff_t const stride = std::ptrdiff_t(surface_pitch( surface ));
+
+		for( auto _ : aState )
+		{
+			if( 0 == pass )
+			{
+				surface.clear();
+			}
+			else
+			{
+				for( std::uint32_t x = 0; x < width; x += 16 )
+					fill_column( surface.get_surface_ptr() + 4*x, stride, int(height), rgbx );
+			}
+
+			benchmark::ClobberMemory(); 
+		}
+
+		std::int64_t const pixels = 0 == pass ? std::int64_t(width) * height : std::int64_t(width/16) * height;
+		aState.SetBytesProcessed( pixels * 4 * aState.iterations() );
+		aState.SetLabel( to_string( surface_storage( surface ) ) );
+	}
 
 	// void my_other_blit_( benchmark::State& aState )
 	// {
@@ -117,6 +204,27 @@ BENCHMARK( blit_ex_memcpy_earth )
 	->Args( { 7680, 4320 } )
 ;
 
+BENCHMARK( surface_clear_ )
+	->ArgNames( { "w", "h", "method" } )
+	->Args( { 1920, 1080, 0 } )
+	->Args( { 1920, 1080, 1 } )
+	->Args( { 7680, 4320, 0 } )
+	->Args( { 7680, 4320, 1 } )
+;
+
+BENCHMARK( surface_fill_ )
+	->ArgNames( { "w", "h" } )
+	->Args( { 1920, 1080 } )
+	->Args( { 7680, 4320 } )
+;
+BENCHMARK( surface_storage_ )
+	->ArgNames( { "w", "h", "storage", "pass" } )
+	->ArgsProduct( {
+		{ 7680 }, { 4320 },
+		{ 0, 1, 2 }, // aligned, huge pages (THP), hugetlb
+		{ 0, 1 } // clear, columns
+	} )
+;
 
 //BENCHMARK( my_other_blit_ )
 //	->Args( { 1920, 1080 } )
@@ -0,0 +1,181 @@
+#include "color.hpp"
+
+#include <bit>
+#include <limits>
+#include <iterator>
+#include <algorithm>
+
+namespace
+{
+	// Returns the smallest float in [0,1] that linear_to_srgb_exact() encodes
+	// to aTarget or higher. Non-negative floats are ordered like their bit
+	// patterns, so this is a binary search over the latter.
+	float find_threshold_( int aTarget ) noexcept
+	{
+		std::uint32_t lo = 0, hi = std::bit_cast<std::uint32_t>( 1.f );
+		while( lo < hi )
+		{
+			std::uint32_t const mid = lo + (hi-lo)/2;
+			if( linear_to_srgb_exact( std::bit_cast<float>( mid ) ) >= aTarget )
+				hi = mid;
+			else
+				lo = mid+1;
+		}
+
+		return std::bit_cast<float>( lo );
+	}
+
+	SrgbTables make_srgb_tables_() noexcept
+	{
+		SrgbTables tables;
+
+		tables.threshold[0] = 0.f;
+		for( int k = 1; k < 256; ++k )
+			tables.threshold[k] = find_threshold_( k );
+		tables.threshold[256] = std::numeric_limits<float>::infinity();
+
+		for( int i = 0; i < kSrgbLutSize; ++i )
+			tables.base[i] = linear_to_srgb_exact( float(i) / float(kSrgbLutSize) );
+		std::fill( tables.base + kSrgbLutSize, std::end( tables.base ), std::uint8_t(255) );
+
+		for( int i = 0; i < 256; ++i )
+			tables.decode[i] = linear_from_srgb_exact( std::uint8_t(i) );
+
+		return tables;
+	}
+}
+
+SrgbTables const& srgb_tables() noexcept
+{
+	static SrgbTables const tables = make_srgb_tables_();
+	return tables;
+}
+
+#if DRAW2D_CFG_ENABLE_AVX2
+DRAW2D_TARGET_AVX2
+__m256i linear_to_srgb_avx2( __m256 aR, __m256 aG, __m256 aB ) noexcept
+{
+#	if DRAW2D_CFG_SRGB_MODE == DRAW2D_CFG_SRGB_EXACT || DRAW2D_CFG_SRGB_MODE == DRAW2D_CFG_SRGB_LUT
+	static SrgbTables const& tables = srgb_tables();
+
+	__m256i const r = srgb_encode_lut_avx2( aR, tables );
+	__m256i const g = srgb_encode_lut_avx2( aG, tables );
+	__m256i const b = srgb_encode_lut_avx2( aB, tables );
+
+	return _mm256_or_si256( r, _mm256_or_si256( _mm256_slli_epi32( g, 8 ), _mm256_slli_epi32( b, 16 ) ) );
+
+#	else
+	// No vector version of the approximate modes; these are encoded per lane.
+	alignas(32) float r[8], g[8], b[8];
+	_mm256_store_ps( r, aR );
+	_mm256_store_ps( g, aG );
+	_mm256_store_ps( b, aB );
+
+	alignas(32) std::uint32_t rgbx[8];
+	for( int i = 0; i < 8; ++i )
+	{
+		ColorU8_sRGB const col = linear_to_srgb( ColorF{ r[i], g[i], b[i] } );
+		rgbx[i] = std::uint32_t(col.r) | std::uint32_t(col.g) << 8 | std::uint32_t(col.b) << 16;
+	}
+
+	return _mm256_load_si256( reinterpret_cast<__m256i const*>(rgbx) );
+#	endif // ~ DRAW2D_CFG_SRGB_MODE
+}
+
+namespace
+{
+	DRAW2D_TARGET_AVX2
+	void linear_to_srgb_batch_avx2_( std::size_t aCount, ColorF const* aColors, std::uint8_t* aRGBx ) noexcept
+	{
+		// De-interleave 8 ColorFs (24 floats) into separate channels with
+		// gathers. The input is accessed at aColors + 3*lane + channel.
+		__m256i const index = _mm256_setr_epi32( 0, 3, 6, 9, 12, 15, 18, 21 );
+
+		std::size_t i = 0;
+		for( ; i + 8 <= aCount; i += 8 )
+		{
+			float const* base = &aColors[i].r;
+			__m256 const r = _mm256_i32gather_ps( base + 0, index, 4 );
+			__m256 const g = _mm256_i32gather_ps( base + 1, index, 4 );
+			__m256 const b = _mm256_i32gather_ps( base + 2, index, 4 );
+
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>(aRGBx + 4*i), linear_to_srgb_avx2( r, g, b ) );
+		}
+
+		// Tail: copy the remaining colors to a zero-padded buffer
+		if( i < aCount )
+		{
+			std::size_t const rest = aCount - i;
+
+			ColorF tail[8] = {};
+			std::copy( aColors + i, aColors + aCount, tail );
+
+			alignas(32) std::uint8_t out[32];
+			linear_to_srgb_batch_avx2_( 8, tail, out );
+			std::copy( out, out + 4*rest, aRGBx + 4*i );
+		}
+	}
+
+#	if DRAW2D_CFG_SRGB_MODE == DRAW2D_CFG_SRGB_EXACT || DRAW2D_CFG_SRGB_MODE == DRAW2D_CFG_SRGB_LUT
+	DRAW2D_TARGET_AVX2
+	void linear_from_srgb_batch_avx2_( std::size_t aCount, std::uint8_t const* aRGBx, ColorF* aColors ) noexcept
+	{
+		static SrgbTables const& tables = srgb_tables();
+		__m256i const byte = _mm256_set1_epi32( 0xff );
+
+		std::size_t i = 0;
+		for( ; i + 8 <= aCount; i += 8 )
+		{
+			__m256i const rgbx = _mm256_loadu_si256( reinterpret_cast<__m256i const*>(aRGBx + 4*i) );
+
+			alignas(32) float r[8], g[8], b[8];
+			_mm256_store_ps( r, _mm256_i32gather_ps( tables.decode, _mm256_and_si256( rgbx, byte ), 4 ) );
+			_mm256_store_ps( g, _mm256_i32gather_ps( tables.decode, _mm256_and_si256( _mm256_srli_epi32( rgbx, 8 ), byte ), 4 ) );
+			_mm256_store_ps( b, _mm256_i32gather_ps( tables.decode, _mm256_and_si256( _mm256_srli_epi32( rgbx, 16 ), byte ), 4 ) );
+
+			for( int j = 0; j < 8; ++j )
+				aColors[i+j] = ColorF{ r[j], g[j], b[j] };
+		}
+
+		for( ; i < aCount; ++i )
+		{
+			std::uint8_t const* px = aRGBx + 4*i;
+			aColors[i] = ColorF{ tables.decode[px[0]], tables.decode[px[1]], tables.decode[px[2]] };
+		}
+	}
+#	endif // ~ DRAW2D_CFG_SRGB_MODE
+}
+#endif // ~ ENABLE_AVX2
+
+void linear_to_srgb( std::size_t aCount, ColorF const* aColors, std::uint8_t* aRGBx ) noexcept
+{
+#	if DRAW2D_CFG_ENABLE_AVX2
+	if( cpu_has_avx2() )
+		return linear_to_srgb_batch_avx2_( aCount, aColors, aRGBx );
+#	endif // ~ ENABLE_AVX2
+
+	for( std::size_t i = 0; i < aCount; ++i )
+	{
+		ColorU8_sRGB const col = linear_to_srgb( ColorF{
+			std::clamp( aColors[i].r, 0.f, 1.f ),
+			std::clamp( aColors[i].g, 0.f, 1.f ),
+			std::clamp( aColors[i].b, 0.f, 1.f )
+		} );
+
+		aRGBx[4*i+0] = col.r;
+		aRGBx[4*i+1] = col.g;
+		aRGBx[4*i+2] = col.b;
+		aRGBx[4*i+3] = 0;
+	}
+}
+
+void linear_from_srgb( std::size_t aCount, std::uint8_t const* aRGBx, ColorF* aColors ) noexcept
+{
+#	if DRAW2D_CFG_ENABLE_AVX2 && (DRAW2D_CFG_SRGB_MODE == DRAW2D_CFG_SRGB_EXACT || DRAW2D_CFG_SRGB_MODE == DRAW2D_CFG_SRGB_LUT)
+	if( cpu_has_avx2() )
+		return linear_from_srgb_batch_avx2_( aCount, aRGBx, aColors );
+#	endif // ~ ENABLE_AVX2
+
+	for( std::size_t i = 0; i < aCount; ++i )
+		aColors[i] = linear_from_srgb( ColorU8_sRGB{ aRGBx[4*i+0], aRGBx[4*i+1], aRGBx[4*i+2] } );
+}
@@ -2,8 +2,11 @@
 #define COLOR_HPP_1239E14D_0FDD_4FA5_BF6B_ADB891884682
 
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 
+#include "cpu.hpp"
+
 /* Compile-time configuration:
  * Pick between different approximations for color conversion from linear RGB
  * to sRGB. EXACT uses the correct published sRGB coversion method [1-3]. FAST
@@ -18,10 +21,16 @@
 #define DRAW2D_CFG_SRGB_EXACT 1
 #define DRAW2D_CFG_SRGB_FAST 2
 #define DRAW2D_CFG_SRGB_FASTER 3
+#define DRAW2D_CFG_SRGB_LUT 4
 
-// The default is to use EXACT. You can change the following to pick a 
-// different method.
-#define DRAW2D_CFG_SRGB_MODE DRAW2D_CFG_SRGB_EXACT
+/* LUT produces the same results as EXACT for all inputs in [0,1], but
+ * replaces the std::pow() calls with table lookups. The encoding tables are
+ * built once, on first use, from the EXACT functions (see SrgbTables below).
+ *
+ * The default is to use LUT. You can change the following to pick a 
+ * different method.
+ */
+#define DRAW2D_CFG_SRGB_MODE DRAW2D_CFG_SRGB_LUT
 
 
 /** Linear RGB color
@@ -72,5 +81,78 @@ float linear_from_srgb( std::uint8_t aValue ) noexcept;
 ColorU8_sRGB linear_to_srgb( ColorF const& ) noexcept;
 ColorF linear_from_srgb( ColorU8_sRGB const& ) noexcept;
 
+// The EXACT conversions, regardless of DRAW2D_CFG_SRGB_MODE:
+
+std::uint8_t linear_to_srgb_exact( float aValue ) noexcept;
+float linear_from_srgb_exact( std::uint8_t aValue ) noexcept;
+
+
+/** sRGB conversion tables
+ *
+ * Tables used by the LUT mode. The encoding is a step function with 256
+ * steps. threshold[k] holds the smallest float that encodes to k or higher
+ * (threshold[256] is infinity). The interval [0,1] is divided into
+ * kSrgbLutSize cells, and base[i] holds the encoded value at the start of
+ * the i-th cell. Adjacent thresholds are at least 3e-4 apart (the steepest
+ * part of the curve is the linear segment near zero, which has a slope of
+ * 255*12.92), so each cell contains at most one step. Encoding a value v
+ * thus reduces to
+ *
+ *   k = base[cell(v)]; return k + (v >= threshold[k+1]);
+ *
+ * decode[] holds the linear value for each 8-bit sRGB value.
+ */
+constexpr int kSrgbLutBits = 12;
+constexpr int kSrgbLutSize = 1 << kSrgbLutBits;
+
+struct SrgbTables
+{
+	std::uint8_t base[kSrgbLutSize + 3]; // +3: padding for 32-bit gathers
+	float threshold[257];
+	float decode[256];
+};
+
+// Returns the conversion tables. They are built on the first call.
+SrgbTables const& srgb_tables() noexcept;
+
+
+/** Batch conversions
+ *
+ * Convert aCount colors between linear RGB (ColorF) and packed sRGB. The
+ * packed colors use the same 32-bit RGBx layout as Surface, i.e., aRGBx
+ * holds 4*aCount bytes. The padding byte is written as zero. Linear values
+ * are clamped to [0,1] before encoding.
+ *
+ * The results are identical to the scalar functions above. With the EXACT
+ * and LUT modes, the conversions use AVX2 kernels if available (see
+ * linear_to_srgb_avx2() below).
+ */
+void linear_to_srgb( std::size_t aCount, ColorF const* aColors, std::uint8_t* aRGBx ) noexcept;
+void linear_from_srgb( std::size_t aCount, std::uint8_t const* aRGBx, ColorF* aColors ) noexcept;
+
+#if DRAW2D_CFG_ENABLE_AVX2
+/** Encode 8 linear colors to packed RGBx
+ *
+ * Takes the three channels of 8 colors (in [0,1]) in separate registers and
+ * returns the 8 encoded colors as packed 32-bit RGBx values. Only call this
+ * if cpu_has_avx2() is true.
+ *
+ * With the EXACT and LUT modes, this performs the LUT encoding on all 8
+ * lanes at once, using gathers to access the SrgbTables.
+ */
+DRAW2D_TARGET_AVX2
+__m256i linear_to_srgb_avx2( __m256 aR, __m256 aG, __m256 aB ) noexcept;
+
+/** Encode 8 linear values with the LUT
+ *
+ * Encodes each lane of aValue (clamped to [0,1]) separately with the
+ * SrgbTables, independently of DRAW2D_CFG_SRGB_MODE. Returns the 8-bit
+ * results in the low byte of each 32-bit lane. Only call this if
+ * cpu_has_avx2() is true.
+ */
+DRAW2D_TARGET_AVX2
+__m256i srgb_encode_lut_avx2( __m256 aValue, SrgbTables const& ) noexcept;
+#endif // ~ ENABLE_AVX2
+
 #include "color.inl"
 #endif // COLOR_HPP_1239E14D_0FDD_4FA5_BF6B_ADB891884682
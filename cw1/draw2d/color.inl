@@ -1,11 +1,42 @@
+#include <algorithm>
+
 inline
-std::uint8_t linear_to_srgb( float aValue ) noexcept
+std::uint8_t linear_to_srgb_exact( float aValue ) noexcept
 {
-#	if DRAW2D_CFG_SRGB_MODE == DRAW2D_CFG_SRGB_EXACT
 	if( aValue < 0.0031308f )
 		return std::uint8_t(255.f * 12.92f * aValue + 0.5f);
 	
 	return std::uint8_t(255.f * (1.055f * std::pow( aValue, 1.f/2.4f ) - 0.055f) + 0.5f);
+}
+
+inline
+float linear_from_srgb_exact( std::uint8_t aValue ) noexcept
+{
+	float const fvalue = float(aValue) / 255.f;
+
+	if( fvalue < 0.04045f )
+		return (1.f/12.92f) * fvalue;
+
+	return std::pow( (1.f/1.055f) * (fvalue + 0.055f), 2.4f );
+}
+
+inline
+std::uint8_t linear_to_srgb( float aValue ) noexcept
+{
+#	if DRAW2D_CFG_SRGB_MODE == DRAW2D_CFG_SRGB_EXACT
+	return linear_to_srgb_exact( aValue );
+
+#	elif DRAW2D_CFG_SRGB_MODE == DRAW2D_CFG_SRGB_LUT
+	// aValue * kSrgbLutSize is exact (power of two), so the cells are exactly
+	// [i/kSrgbLutSize, (i+1)/kSrgbLutSize). The only value that falls outside
+	// of the table is 1.0, which belongs to the last cell. Inputs outside of
+	// [0,1] are clamped first; the comparison also maps NaN to zero.
+	static SrgbTables const& tables = srgb_tables();
+
+	float const value = aValue > 0.f ? std::min( aValue, 1.f ) : 0.f;
+	int const cell = std::min( int(value * float(kSrgbLutSize)), kSrgbLutSize-1 );
+	int const base = tables.base[cell];
+	return std::uint8_t(base + (value >= tables.threshold[base+1]));
 
 #	elif DRAW2D_CFG_SRGB_MODE == DRAW2D_CFG_SRGB_FAST
 	return std::uint8_t(255.f * std::pow( aValue, 1.f/2.4f ) + 0.5f);
@@ -19,18 +50,19 @@ std::uint8_t linear_to_srgb( float aValue ) noexcept
 inline
 float linear_from_srgb( std::uint8_t aValue ) noexcept
 {
-	float const fvalue = float(aValue) / 255.f;
-
 #	if DRAW2D_CFG_SRGB_MODE == DRAW2D_CFG_SRGB_EXACT
-	if( fvalue < 0.04045f )
-		return (1.f/12.92f) * fvalue;
+	return linear_from_srgb_exact( aValue );
 
-	return std::pow( (1.f/1.055f) * (fvalue + 0.055f), 2.4f );
+#	elif DRAW2D_CFG_SRGB_MODE == DRAW2D_CFG_SRGB_LUT
+	static SrgbTables const& tables = srgb_tables();
+	return tables.decode[aValue];
 
 #	elif DRAW2D_CFG_SRGB_MODE == DRAW2D_CFG_SRGB_FAST
+	float const fvalue = float(aValue) / 255.f;
 	return std::pow( fvalue, 2.4f );
 
 #	elif DRAW2D_CFG_SRGB_MODE == DRAW2D_CFG_SRGB_FASTER
+	float const fvalue = float(aValue) / 255.f;
 	return fvalue * fvalue;
 
 #	endif // ~ DRAW2D_CFG_SRGB_MODE
@@ -56,3 +88,29 @@ ColorF linear_from_srgb( ColorU8_sRGB const& aColor ) noexcept
 		linear_from_srgb( aColor.b )
 	};
 }
+
+#if DRAW2D_CFG_ENABLE_AVX2
+DRAW2D_TARGET_AVX2 inline
+__m256i srgb_encode_lut_avx2( __m256 aValue, SrgbTables const& aTables ) noexcept
+{
+	// Same steps as the scalar LUT version. The base table holds bytes; the
+	// gather loads 32 bits starting at the byte in question, and the extra
+	// bytes are masked off (SrgbTables::base is padded for this).
+	__m256 const value = _mm256_min_ps( _mm256_max_ps( aValue, _mm256_setzero_ps() ), _mm256_set1_ps( 1.f ) );
+
+	__m256i const cell = _mm256_min_epi32(
+		_mm256_cvttps_epi32( _mm256_mul_ps( value, _mm256_set1_ps( float(kSrgbLutSize) ) ) ),
+		_mm256_set1_epi32( kSrgbLutSize-1 )
+	);
+
+	__m256i const bytes = _mm256_i32gather_epi32( reinterpret_cast<int const*>(aTables.base), cell, 1 );
+	__m256i const base = _mm256_and_si256( bytes, _mm256_set1_epi32( 0xff ) );
+
+	__m256i const next = _mm256_add_epi32( base, _mm256_set1_epi32( 1 ) );
+	__m256 const threshold = _mm256_i32gather_ps( aTables.threshold, next, 4 );
+
+	// The comparison mask is -1 where true
+	__m256i const step = _mm256_castps_si256( _mm256_cmp_ps( value, threshold, _CMP_GE_OQ ) );
+	return _mm256_sub_epi32( base, step );
+}
+#endif // ~ ENABLE_AVX2
@@ -0,0 +1,47 @@
+#include "cpu.hpp"
+
+#if DRAW2D_CFG_ENABLE_AVX2 && defined(_MSC_VER) && !defined(__clang__)
+#	include <intrin.h>
+#endif
+
+namespace
+{
+	bool detect_avx2_() noexcept
+	{
+#		if !DRAW2D_CFG_ENABLE_AVX2
+		return false;
+
+#		elif defined(__GNUC__) || defined(__clang__)
+		// __builtin_cpu_supports() also checks that the OS has enabled the
+		// AVX state.
+		__builtin_cpu_init();
+		return __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" );
+
+#		else // MSVC
+		int info[4];
+		__cpuid( info, 0 );
+		if( info[0] < 7 )
+			return false;
+
+		__cpuid( info, 1 );
+		bool const fma = info[2] & (1 << 12);
+		bool const osxsave = info[2] & (1 << 27);
+		if( !fma || !osxsave )
+			return false;
+
+		// XCR0 bits 1 and 2: the OS saves the XMM and YMM state
+		if( (_xgetbv( 0 ) & 0x6) != 0x6 )
+			return false;
+
+		__cpuidex( info, 7, 0 );
+		return info[1] & (1 << 5);
+
+#		endif
+	}
+}
+
+bool cpu_has_avx2() noexcept
+{
+	static bool const hasAVX2 = detect_avx2_();
+	return hasAVX2;
+}
@@ -0,0 +1,37 @@
+#ifndef CPU_HPP_3B1C12AD_032F_440A_ADF9_986CC24DCA04
+#define CPU_HPP_3B1C12AD_032F_440A_ADF9_986CC24DCA04
+
+/* Compile time config: build the AVX2 kernels?
+ *
+ * Enabled by default on x86-64. The AVX2 kernels are compiled with the
+ * necessary target attributes regardless of the global compiler flags, and
+ * are only used if cpu_has_avx2() returns true at runtime. The scalar code
+ * remains as the fallback, so the library still runs on older CPUs. Define
+ * DRAW2D_CFG_ENABLE_AVX2=0 to disable the kernels entirely.
+ */
+#if !defined(DRAW2D_CFG_ENABLE_AVX2)
+#	if defined(__x86_64__) || defined(_M_X64)
+#		define DRAW2D_CFG_ENABLE_AVX2 1
+#	else
+#		define DRAW2D_CFG_ENABLE_AVX2 0
+#	endif
+#endif // ~ ENABLE_AVX2
+
+#if DRAW2D_CFG_ENABLE_AVX2
+#	include <immintrin.h>
+
+	// MSVC allows the use of any intrinsic without additional flags. GCC and
+	// clang require the target to be specified per function.
+#	if defined(__GNUC__) || defined(__clang__)
+#		define DRAW2D_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#	else
+#		define DRAW2D_TARGET_AVX2
+#	endif
+#endif // ~ ENABLE_AVX2
+
+// Returns true if the AVX2 kernels can be used. This requires that they were
+// compiled in, that the CPU supports both AVX2 and FMA, and that the OS saves
+// the YMM registers. The result is determined once and then cached.
+bool cpu_has_avx2() noexcept;
+
+#endif // CPU_HPP_3B1C12AD_032F_440A_ADF9_986CC24DCA04
@@ -5,66 +5,99 @@
 #include <cstring> // for std::memcpy()
 
 #include "draw.hpp"
+#include "fill.hpp"
+#include "line.hpp"
 #include "image.hpp"
+#include "storage.hpp"
 #include "surface-ex.hpp"
 
-void draw_ex_line_solid( SurfaceEx& aSurface, Vec2f aBegin, Vec2f aEnd, ColorU8_sRGB aColor )
+namespace
 {
-	using namespace std;
-
-	if (!clip_line(aSurface.clip_area(), aBegin, aEnd))
-		return;
-
-	int x0 = static_cast<int>(lround(aBegin.x));
-	int y0 = static_cast<int>(lround(aBegin.y));
-	int x1 = static_cast<int>(lround(aEnd.x));
-	int y1 = static_cast<int>(lround(aEnd.y));
-
-	const int W = static_cast<int>(aSurface.get_width());
-	const int H = static_cast<int>(aSurface.get_height());
-
-	auto in_bounds = [W, H](int x, int y) {
-		return (x >= 0 && x < W && y >= 0 && y < H);
-	};
-
-	int dx = abs(x1 - x0);
-	int dy = abs(y1 - y0);
-
-	int sx = (x0 < x1) ? 1 : -1;
-	int sy = (y0 < y1) ? 1 : -1;
-
-	// implementation of Bresenham's line algorithm
-
-	if (in_bounds(x0, y0)) {
-	 aSurface.set_pixel_srgb(static_cast<Surface::Index>(x0), static_cast<Surface::Index>(y0), aColor);
-	 if ( dx >= dy ) {
-			int err = dx / 2;
-			while (x0 != x1) {
-				x0 += sx;
-				err -= dy;
-				if (err < 0) {
-					y0 += sy;
-					err += dx;
-				}
-				if (in_bounds(x0, y0))
-					aSurface.set_pixel_srgb(static_cast<Surface::Index>(x0), static_cast<Surface::Index>(y0), aColor);
-			}		
-	 } else	{
-			int err = dy / 2;
-			while (y0 != y1) {
-				y0 += sy;
-				err -= dx;
-				if (err < 0) {
-					x0 += sx;
-					err += dy;
-				}
-				if (in_bounds(x0, y0))
-					aSurface.set_pixel_srgb(static_cast<Surface::Index>(x0), static_cast<Surface::Index>(y0), aColor);
-			}
+	// Sets up the Bresenham walk for draw_ex_line_solid() and its symmetric
+	// variant. Returns false if nothing is drawn.
+	bool setup_ex_line_( SurfaceEx& aSurface, Vec2f aBegin, Vec2f aEnd, LineWalk& aWalk )
+	{
+		using namespace std;
+
+		if (!clip_line(aSurface.clip_area(), aBegin, aEnd))
+			return false;
+
+		int x0 = static_cast<int>(lround(aBegin.x));
+		int y0 = static_cast<int>(lround(aBegin.y));
+		int x1 = static_cast<int>(lround(aEnd.x));
+		int y1 = static_cast<int>(lround(aEnd.y));
+
+		const int W = static_cast<int>(aSurface.get_width());
+		const int H = static_cast<int>(aSurface.get_height());
+
+		// nothing is drawn if the first pixel is outside of the surface
+		if (x0 < 0 || x0 >= W || y0 < 0 || y0 >= H)
+			return false;
+
+		int dx = abs(x1 - x0);
+		int dy = abs(y1 - y0);
+
+		int sx = (x0 < x1) ? 1 : -1;
+		int sy = (y0 < y1) ? 1 : -1;
+
+		// implementation of Bresenham's line algorithm. the octant kernel (see
+		// line.hpp) runs the loop; its remainder is major-1-err, which counts up
+		// towards the major extent where err counts down towards zero.
+		const bool xMajor = dx >= dy;
+		const int major = xMajor ? dx : dy;
+		const int minor = xMajor ? dy : dx;
+
+		// rows may be padded (see SurfacePitch)
+		const size_t pitch = surface_pitch(aSurface);
+		aWalk.pixel = aSurface.get_surface_ptr() + size_t(y0) * pitch + size_t(x0) * 4;
+		aWalk.rowStride = ptrdiff_t(pitch);
+
+		aWalk.xMajor = xMajor;
+		aWalk.majorDir = xMajor ? sx : sy;
+		aWalk.minorDir = xMajor ? sy : sx;
+
+		aWalk.den = max(major, 1);
+		aWalk.step = minor;
+		aWalk.rem = max(major - 1 - major / 2, 0);
+
+		// x and y are monotonic along the line, so once a pixel leaves the
+		// surface, all remaining ones do too. stop before the first such pixel
+		// instead of testing each one.
+		const int majorPos = xMajor ? x0 : y0;
+		const int minorPos = xMajor ? y0 : x0;
+		const int majorSize = xMajor ? W : H;
+		const int minorSize = xMajor ? H : W;
+
+		const int majorRoom = aWalk.majorDir > 0 ? majorSize - majorPos : majorPos + 1;
+		const int minorRoom = aWalk.minorDir > 0 ? minorSize - minorPos : minorPos + 1;
+
+		int64_t count = min(major + 1, majorRoom);
+		if (minor > 0) {
+			// the minor coordinate has moved floor((rem + i*step) / den) pixels
+			// at step i
+			const int64_t need = int64_t(minorRoom) * aWalk.den - aWalk.rem;
+			count = min(count, (need + aWalk.step - 1) / aWalk.step);
 		}
+
+		aWalk.count = static_cast<int>(count);
+		return true;
 	}
 }
 
+void draw_ex_line_solid( SurfaceEx& aSurface, Vec2f aBegin, Vec2f aEnd, ColorU8_sRGB aColor )
+{
+	LineWalk walk;
+	if (setup_ex_line_(aSurface, aBegin, aEnd, walk))
+		draw_line_octant(walk, pack_rgbx(aColor));
+}
+
+void draw_ex_line_solid_symmetric( SurfaceEx& aSurface, Vec2f aBegin, Vec2f aEnd, ColorU8_sRGB aColor )
+{
+	LineWalk walk;
+	if (setup_ex_line_(aSurface, aBegin, aEnd, walk))
+		draw_line_octant_symmetric(walk, pack_rgbx(aColor));
+}
+
 void blit_ex_solid( SurfaceEx& aSurface, ImageRGBA const& aImage, Vec2f aPosition )
 {
 
@@ -93,11 +126,14 @@ void blit_ex_solid( SurfaceEx& aSurface, ImageRGBA const& aImage, Vec2f aPositio
 
 	for (int y = y0, image_y = image_y0; y < y1; ++y, ++image_y) {
 
+		// row pointer instead of set_pixel_srgb(), see blit_masked()
+		std::uint8_t* const row = surface_row_ptr(aSurface, (Surface::Index)y);
+
 		for (int x = x0, image_x = image_x0; x < x1; ++x, ++image_x) {
 
 			ColorU8_sRGB_Alpha color_of_pixel = aImage.get_pixel((ImageRGBA::Index)image_x, (ImageRGBA::Index)image_y);
-			aSurface.set_pixel_srgb((Surface::Index)x, (Surface::Index)y,
-			ColorU8_sRGB{ color_of_pixel.r, color_of_pixel.g, color_of_pixel.b });
+			std::uint32_t const rgbx = pack_rgbx(ColorU8_sRGB{ color_of_pixel.r, color_of_pixel.g, color_of_pixel.b });
+			std::memcpy(row + 4*x, &rgbx, sizeof(rgbx));
 		}
 	}
 }
@@ -129,8 +165,9 @@ void blit_ex_memcpy( SurfaceEx& aSurface, ImageRGBA const& aImage, Vec2f aPositi
 	const std::uint8_t* imgBase = aImage.get_image_ptr();
 
 	// both surface and image are stored in row-major order
-	// and each pixel is 4 bytes (RGBA)
-	const int surfRowBytes = surfWidth	* 4;
+	// and each pixel is 4 bytes (RGBA). surface rows may be padded
+	// (see SurfacePitch).
+	const std::size_t surfRowBytes = surface_pitch(aSurface);
 	const int imgRowBytes = imgWidth * 4;
 	// the width of the intersection of 2 rectangles in bytes
 	const int copyBytes = (x1 - x0) * 4; 
@@ -151,7 +188,7 @@ void blit_ex_memcpy( SurfaceEx& aSurface, ImageRGBA const& aImage, Vec2f aPositi
 void draw_ex_diagonal( SurfaceEx& aSurface, Vec2f aBegin, float aSteps, ColorU8_sRGB aColor )
 {
 	std::size_t const steps = std::size_t(aSteps);
-	std::size_t const stride = 4*aSurface.get_width();
+	std::size_t const stride = surface_pitch( aSurface );
 
 	std::uint8_t* sptr = aSurface.get_surface_ptr();
 	// navigating pointer location from the beginning of the surface
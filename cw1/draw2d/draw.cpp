@@ -6,7 +6,38 @@
 
 #include <cmath>
 
+#include "fill.hpp"
+#include "line.hpp"
+#include "storage.hpp"
 #include "surface.hpp"
+#include "triangle.hpp"
+
+namespace
+{
+	bool same_color_( ColorF const& aA, ColorF const& aB ) noexcept
+	{
+		return aA.r == aB.r && aA.g == aB.g && aA.b == aB.b;
+	}
+
+	// Rectangles cover the pixels whose centers lie in [aMin, aMax), similar
+	// to the triangle fill rule. Returns the first and last pixel of that
+	// range, clamped to [-1, aSize]; i.e., results that lie outside of the
+	// surface remain outside of it. Returns false if the range is empty.
+	bool rect_pixel_range_( float aMin, float aMax, Surface::Index aSize, int& aFirst, int& aLast ) noexcept
+	{
+		float const first = std::ceil( std::min( aMin, aMax ) - 0.5f );
+		float const end = std::ceil( std::max( aMin, aMax ) - 0.5f );
+
+		// Written such that NaNs are rejected
+		if( !(first < end) )
+			return false;
+
+		float const limit = float(aSize);
+		aFirst = int(std::clamp( first, -1.f, limit ));
+		aLast = int(std::clamp( end - 1.f, -1.f, limit ));
+		return true;
+	}
+}
 
 
 bool clip_line( Rect2F const& aTargetArea, Vec2f& aBegin, Vec2f& aEnd )
@@ -70,71 +101,39 @@ bool clip_line( Rect2F const& aTargetArea, Vec2f& aBegin, Vec2f& aEnd )
 
 void draw_clip_line_solid( Surface& aSurface, Vec2f aBegin, Vec2f aEnd, ColorU8_sRGB aColor )
 {
+	// 0. exactly horizontal and vertical lines are clipped and filled
+	// directly (see line.hpp)
+	if (draw_line_axis_aligned(aSurface, aSurface.clip_area(), aBegin, aEnd, pack_rgbx(aColor)))
+		return;
 
-	using namespace std;
 	// 1. check if the line is in the surface area using clip_line()
 	if (!clip_line(aSurface.clip_area(), aBegin, aEnd))
 		return;
 
-	const int W = (int)aSurface.get_width();
-	const int H = (int)aSurface.get_height();
-
-	auto in_bounds = [&](int x, int y) {
-		return (x >= 0 && x < W && y >= 0 && y < H);
-	};
-	// 2. check if 2 vectors are the same	(degenerate case)
-	if (aBegin.x == aEnd.x && aBegin.y == aEnd.y) {
-		int x = (int)lround(aBegin.x);
-		int y = (int)lround(aBegin.y);
-		if (in_bounds(x, y))
-			aSurface.set_pixel_srgb((Surface::Index)x, (Surface::Index)y, aColor);
+	// 2. set up integer stepping along the line (see line.hpp). this also
+	// drops steps that the clipped endpoints round to outside of the surface,
+	// so the pixels need no further bounds checks.
+	LineSetup setup;
+	if (!setup_line(setup, aSurface, aBegin, aEnd))
 		return;
-	}
-	// 3. draw it by either chooseing x-major or y-major based on the lenth of dx and dy
-	const float dx = aEnd.x - aBegin.x;
-	const float dy = aEnd.y - aBegin.y;
-
-	// 4. calculate the slope, starting point, number of steps
-	const float slope = fabs(dx) >= fabs(dy) ? dy / dx : dx / dy;                 // dy per 1 in x             // dx per 1 in y
-	// we get the start point vector
-	Vec2f startPoint = fabs(dx) >= fabs(dy) ? aBegin.x == min(aBegin.x, aEnd.x) ? aBegin : aEnd
-																																								: aBegin.y == min(aBegin.y, aEnd.y) ? aBegin : aEnd;
-	// float a = fabs(dx) > fabs(dy) ? startPoint.y : startPoint.x;
-	// float b = a == startPoint.x ? startPoint.y : startPoint.x;
-	int numberOfSteps = fabs(dx) >= fabs(dy) ? abs((int)lround(aBegin.x - aEnd.x)) + 1 
-																																: abs((int)lround(aBegin.y - aEnd.y)) + 1;
-	// 5. make sure each pixels are adjacent
- // 6. loop through and set pixels using set_pixel_srgb()
-	if (fabs(dx) >= fabs(dy)) {
-		int x = (int)lround(startPoint.x);
-		// float y = startPoint.y + (float(x) - startPoint.x) * slope;
-		float y = startPoint.y;
-		for (int i = 0; i < numberOfSteps; ++i) {
-			if (in_bounds(x, (int)lround(y))) 
-				aSurface.set_pixel_srgb((Surface::Index)(int)x, (Surface::Index)(int)lround(y), aColor);
-			x += 1;
-			y += slope;
-		}
-	} else {
-		int y = (int)lround(startPoint.y);
-		// float x = startPoint.x + (float(y) - startPoint.y) * (1.0f / slope);
-		float x = startPoint.x;
-		for (int i = 0; i < numberOfSteps; ++i) {
-			if (in_bounds((int)lround(x), y)) 	
-					aSurface.set_pixel_srgb((Surface::Index)(int)lround(x), (Surface::Index)y, aColor);
-		x += slope; 
-		y += 1;
-	}
-}
+
+	// 3. set the pixels
+	rasterize_line(aSurface, setup, pack_rgbx(aColor));
 }
 
 void draw_line_solid( Surface& aSurface, Vec2f aBegin, Vec2f aEnd, ColorU8_sRGB aColor )
 {
+	if( draw_line_axis_aligned( aSurface, aSurface.clip_area(), aBegin, aEnd, pack_rgbx( aColor ) ) )
+		return;
+
 	if( clip_line( aSurface.clip_area(), aBegin, aEnd ) )
 		draw_clip_line_solid( aSurface, aBegin, aEnd, aColor );
 }
 void draw_line_solid( Surface& aSurface, Rect2F const& aClipArea, Vec2f aBegin, Vec2f aEnd, ColorU8_sRGB aColor )
 {
+	if( draw_line_axis_aligned( aSurface, aClipArea, aBegin, aEnd, pack_rgbx( aColor ) ) )
+		return;
+
 	if( clip_line( aClipArea, aBegin, aEnd ) )
 		draw_clip_line_solid( aSurface, aBegin, aEnd, aColor );
 }
@@ -191,32 +190,27 @@ ColorU8_sRGB interpolation (	barycentric_coords const& aBary, ColorF const& aC0,
 
 void draw_triangle_interp( Surface& aSurface, Vec2f aP0, Vec2f aP1, Vec2f aP2, ColorF aC0, ColorF aC1, ColorF aC2 )
 {
-	// check if the triangle is degenerate (area = 0)
-	float area = cross_product(aP1 - aP0, aP2 - aP0);
-	if (area == 0.0f) {
-		return; // degenerate triangle
+	// the setup computes the edge functions (fixed point, top-left fill rule)
+	// and the color gradients once; the rasterizer then only steps them.
+	// degenerate and fully clipped triangles are rejected by the setup.
+	//
+	// with a uniform color, there is nothing to interpolate. the color is
+	// clamped like in the interpolating path, so the results are identical.
+	if( same_color_( aC0, aC1 ) && same_color_( aC0, aC2 ) )
+	{
+		ColorU8_sRGB const color = linear_to_srgb( ColorF{
+			std::clamp( aC0.r, 0.f, 1.f ),
+			std::clamp( aC0.g, 0.f, 1.f ),
+			std::clamp( aC0.b, 0.f, 1.f )
+		} );
+
+		draw_triangle_solid( aSurface, aP0, aP1, aP2, color );
+		return;
 	}
-	// compute bounding box of the triangle
-	bound_box_for_triangle box = bounding_box_for_triangle(aP0, aP1,	aP2);
-	// clamp the bounding box to the surface clip area
-	box = clamping_box(box, aSurface);
 
-	if (box.xmax < box.xmin || box.ymax < box.ymin) {
-		return; // no pixels to draw
-	}
- // for each pixel, check if it's in the triangle using barycentric coordinates
-	// if it is, calculate the interpolated color and set the pixel using the barycetric weights
-
-	for (int x = box.xmin; x <= box.xmax; ++x) {	
-		for (int y = box.ymin; y <= box.ymax; ++y) {
-			Vec2f p = Vec2f{ static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f }; // center of the pixel
-			barycentric_coords bary = barycentric_from_cartesian(p, aP0, aP1, aP2);
-			if (inside_triangle(bary)) {
-				ColorU8_sRGB color = interpolation(bary, aC0, aC1, aC2);
-				aSurface.set_pixel_srgb((Surface::Index)x, (Surface::Index)y, color);
-			}
-		}
-	}
+	TriangleSetup setup;
+	if( setup_triangle( setup, aSurface, aP0, aP1, aP2, aC0, aC1, aC2 ) )
+		rasterize_triangle( aSurface, setup );
 }
 
 // You are not required to implement the following, but they can be useful for
@@ -237,40 +231,69 @@ void draw_triangle_wireframe( Surface& aSurface, Vec2f aP0, Vec2f aP1, Vec2f aP2
 
 void draw_triangle_solid( Surface& aSurface, Vec2f aP0, Vec2f aP1, Vec2f aP2, ColorU8_sRGB aColor )
 {
-	//TODO: your implementation goes here
-	//TODO: your implementation goes here
-	//TODO: your implementation goes here
-
-	//TODO: remove the following when you start your implementation
-	(void)aSurface; // Avoid warnings about unused arguments until the function
-	(void)aP0;   // is properly implemented.
-	(void)aP1;
-	(void)aP2;
-	(void)aColor;
+	// same coverage as draw_triangle_interp(), but each row is filled as a
+	// single span of packed pixels
+	TriangleSetup setup;
+	if( setup_triangle_edges( setup, aSurface, aP0, aP1, aP2 ) )
+		rasterize_triangle_solid( aSurface, setup, pack_rgbx( aColor ) );
 }
 
 void draw_rectangle_solid( Surface& aSurface, Vec2f aMinCorner, Vec2f aMaxCorner, ColorU8_sRGB aColor )
 {
-	//TODO: your implementation goes here
-	//TODO: your implementation goes here
-	//TODO: your implementation goes here
+	int x0, x1, y0, y1;
+	if( !rect_pixel_range_( aMinCorner.x, aMaxCorner.x, aSurface.get_width(), x0, x1 ) )
+		return;
+	if( !rect_pixel_range_( aMinCorner.y, aMaxCorner.y, aSurface.get_height(), y0, y1 ) )
+		return;
 
-	//TODO: remove the following when you start your implementation
-	(void)aSurface; // Avoid warnings about unused arguments until the function
-	(void)aMinCorner;   // is properly implemented.
-	(void)aMaxCorner;
-	(void)aColor;
+	int const xmax = int(aSurface.get_width()) - 1;
+	int const ymax = int(aSurface.get_height()) - 1;
+
+	x0 = std::max( x0, 0 );
+	x1 = std::min( x1, xmax );
+
+	std::uint32_t const rgbx = pack_rgbx( aColor );
+	for( int y = std::max( y0, 0 ); y <= std::min( y1, ymax ); ++y )
+		fill_span( surface_row_ptr( aSurface, Surface::Index(y) ), x0, x1, rgbx );
 }
 
 void draw_rectangle_outline( Surface& aSurface, Vec2f aMinCorner, Vec2f aMaxCorner, ColorU8_sRGB aColor )
 {
-	//TODO: your implementation goes here
-	//TODO: your implementation goes here
-	//TODO: your implementation goes here
+	// the outline consists of the outermost pixels of the rectangle drawn by
+	// draw_rectangle_solid(). the bounds are only clamped to the surface
+	// after determining which of the sides are visible.
+	int x0, x1, y0, y1;
+	if( !rect_pixel_range_( aMinCorner.x, aMaxCorner.x, aSurface.get_width(), x0, x1 ) )
+		return;
+	if( !rect_pixel_range_( aMinCorner.y, aMaxCorner.y, aSurface.get_height(), y0, y1 ) )
+		return;
 
-	//TODO: remove the following when you start your implementation
-	(void)aSurface; // Avoid warnings about unused arguments
-	(void)aMinCorner;
-	(void)aMaxCorner;
-	(void)aColor;
+	int const xmax = int(aSurface.get_width()) - 1;
+	int const ymax = int(aSurface.get_height()) - 1;
+
+	std::uint32_t const rgbx = pack_rgbx( aColor );
+
+	// bottom and top rows
+	for( int y : { y0, y1 } )
+	{
+		if( y >= 0 && y <= ymax )
+			fill_span( surface_row_ptr( aSurface, Surface::Index(y) ), std::max( x0, 0 ), std::min( x1, xmax ), rgbx );
+
+		if( y0 == y1 )
+			break;
+	}
+
+	// left and right columns, without the corners
+	int const colBegin = std::max( y0+1, 0 );
+	int const colEnd = std::min( y1-1, ymax );
+	std::ptrdiff_t const rowStride = std::ptrdiff_t(surface_pitch( aSurface ));
+
+	for( int x : { x0, x1 } )
+	{
+		if( x >= 0 && x <= xmax && colBegin <= colEnd )
+			fill_column( surface_row_ptr( aSurface, Surface::Index(colBegin) ) + 4*x, rowStride, colEnd - colBegin + 1, rgbx );
+
+		if( x0 == x1 )
+			break;
+	}
 }
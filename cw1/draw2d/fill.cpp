@@ -0,0 +1,94 @@
+#include "fill.hpp"
+
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+
+#include "cpu.hpp"
+
+namespace
+{
+	void fill_span_scalar_( std::uint8_t* aPtr, std::size_t aCount, std::uint32_t aRGBx ) noexcept
+	{
+		// Compilers turn the fixed-size memcpy() into a single store (and
+		// typically vectorize the loop).
+		for( std::size_t i = 0; i < aCount; ++i )
+			std::memcpy( aPtr + 4*i, &aRGBx, sizeof(aRGBx) );
+	}
+
+#	if DRAW2D_CFG_ENABLE_AVX2
+	DRAW2D_TARGET_AVX2
+	void fill_span_avx2_( std::uint8_t* aPtr, std::size_t aCount, std::uint32_t aRGBx ) noexcept
+	{
+		__m256i const value = _mm256_set1_epi32( int(aRGBx) );
+
+		std::size_t i = 0;
+		for( ; i + 8 <= aCount; i += 8 )
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>(aPtr + 4*i), value );
+
+		if( i < aCount )
+		{
+			__m256i const lane = _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 );
+			__m256i const mask = _mm256_cmpgt_epi32( _mm256_set1_epi32( int(aCount - i) ), lane );
+			_mm256_maskstore_epi32( reinterpret_cast<int*>(aPtr + 4*i), mask, value );
+		}
+	}
+
+	DRAW2D_TARGET_AVX2
+	void fill_stream_avx2_( std::uint8_t* aPtr, std::size_t aCount, std::uint32_t aRGBx ) noexcept
+	{
+		// Streaming stores must be aligned to 32 bytes. Pixels are aligned to
+		// four bytes, so the head up to the first aligned pixel and the tail
+		// use the normal kernel.
+		std::size_t const head = std::min( aCount, ((32 - (reinterpret_cast<std::uintptr_t>(aPtr) & 31)) & 31) / 4 );
+		fill_span_avx2_( aPtr, head, aRGBx );
+
+		__m256i const value = _mm256_set1_epi32( int(aRGBx) );
+
+		std::size_t i = head;
+		for( ; i + 16 <= aCount; i += 16 )
+		{
+			_mm256_stream_si256( reinterpret_cast<__m256i*>(aPtr + 4*i), value );
+			_mm256_stream_si256( reinterpret_cast<__m256i*>(aPtr + 4*i + 32), value );
+		}
+
+		fill_span_avx2_( aPtr + 4*i, aCount - i, aRGBx );
+
+		// Streaming stores are weakly ordered; make them visible before
+		// anything else touches the surface (e.g., another thread).
+		_mm_sfence();
+	}
+#	endif // ~ ENABLE_AVX2
+}
+
+void fill_span( std::uint8_t* aRowPtr, int aBegin, int aEnd, std::uint32_t aRGBx ) noexcept
+{
+	if( aEnd < aBegin )
+		return;
+
+	std::uint8_t* const ptr = aRowPtr + 4*std::size_t(aBegin);
+	std::size_t const count = std::size_t(aEnd - aBegin) + 1;
+
+#	if DRAW2D_CFG_ENABLE_AVX2
+	if( cpu_has_avx2() )
+		return fill_span_avx2_( ptr, count, aRGBx );
+#	endif // ~ ENABLE_AVX2
+
+	fill_span_scalar_( ptr, count, aRGBx );
+}
+
+void fill_pixels( std::uint8_t* aPtr, std::size_t aCount, std::uint32_t aRGBx ) noexcept
+{
+#	if DRAW2D_CFG_ENABLE_AVX2
+	if( cpu_has_avx2() )
+	{
+		bool const aligned = 0 == (reinterpret_cast<std::uintptr_t>(aPtr) & 3);
+		if( aligned && 4*aCount >= DRAW2D_CFG_FILL_STREAM_BYTES )
+			return fill_stream_avx2_( aPtr, aCount, aRGBx );
+
+		return fill_span_avx2_( aPtr, aCount, aRGBx );
+	}
+#	endif // ~ ENABLE_AVX2
+
+	fill_span_scalar_( aPtr, aCount, aRGBx );
+}
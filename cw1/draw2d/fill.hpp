@@ -0,0 +1,58 @@
+#ifndef FILL_HPP_1F471B35_C957_44B2_A622_CBEBB460175C
+#define FILL_HPP_1F471B35_C957_44B2_A622_CBEBB460175C
+
+// Helpers for filling runs of pixels with a single color. These write
+// directly to the surface memory (see surface_row_ptr()) and are used by
+// the solid drawing functions.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "color.hpp"
+
+/* Compile time config: streaming threshold
+ *
+ * fill_pixels() uses non-temporal (streaming) stores for blocks of at least
+ * this many bytes. Such stores bypass the caches, so that filling a large
+ * surface does not evict everything else, and does not read each cache line
+ * before overwriting it. The default keeps a 1080p surface (8 MB) in the
+ * cache, and streams 4K and 8K ones.
+ */
+#if !defined(DRAW2D_CFG_FILL_STREAM_BYTES)
+#	define DRAW2D_CFG_FILL_STREAM_BYTES (std::size_t(16) << 20)
+#endif // ~ FILL_STREAM_BYTES
+
+/** Pack a sRGB color into a 32-bit pixel
+ *
+ * The returned value has the same in-memory representation as a pixel in
+ * Surface, i.e., the bytes r, g, b, 0 in that order. The padding byte is
+ * zero, like the one written by Surface::set_pixel_srgb().
+ */
+std::uint32_t pack_rgbx( ColorU8_sRGB const& ) noexcept;
+
+/** Fill a span of pixels
+ *
+ * Sets the pixels [aBegin, aEnd] (inclusive) of the row starting at aRowPtr
+ * to the packed color aRGBx. Does nothing if aEnd < aBegin. Uses 256-bit
+ * stores if the CPU supports AVX2.
+ */
+void fill_span( std::uint8_t* aRowPtr, int aBegin, int aEnd, std::uint32_t aRGBx ) noexcept;
+
+/** Fill a block of pixels
+ *
+ * Sets aCount consecutive pixels starting at aPtr to the packed color aRGBx.
+ * Used by Surface::clear() and Surface::fill(). With AVX2, blocks of at
+ * least DRAW2D_CFG_FILL_STREAM_BYTES bytes are written with streaming
+ * stores, followed by a store fence.
+ */
+void fill_pixels( std::uint8_t* aPtr, std::size_t aCount, std::uint32_t aRGBx ) noexcept;
+
+/** Fill a column of pixels
+ *
+ * Sets aCount pixels to the packed color aRGBx, starting at aPixel and
+ * moving down by aRowStride bytes after each. Does nothing if aCount <= 0.
+ */
+void fill_column( std::uint8_t* aPixel, std::ptrdiff_t aRowStride, int aCount, std::uint32_t aRGBx ) noexcept;
+
+#include "fill.inl"
+#endif // FILL_HPP_1F471B35_C957_44B2_A622_CBEBB460175C
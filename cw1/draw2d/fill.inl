@@ -0,0 +1,22 @@
+#include <cstring>
+
+inline
+std::uint32_t pack_rgbx( ColorU8_sRGB const& aColor ) noexcept
+{
+	// Going through memcpy() keeps the byte order independent of the
+	// platform's endianness.
+	std::uint8_t const bytes[4] = { aColor.r, aColor.g, aColor.b, 0 };
+
+	std::uint32_t ret;
+	std::memcpy( &ret, bytes, sizeof(ret) );
+	return ret;
+}
+
+inline
+void fill_column( std::uint8_t* aPixel, std::ptrdiff_t aRowStride, int aCount, std::uint32_t aRGBx ) noexcept
+{
+	// Inline, since columns are often short (e.g., the vertical runs of
+	// steep lines).
+	for( int i = 0; i < aCount; ++i, aPixel += aRowStride )
+		std::memcpy( aPixel, &aRGBx, sizeof(aRGBx) );
+}
@@ -9,6 +9,7 @@ class TriangleFan;
 
 class Surface;
 class SurfaceEx;
+class TiledSurface;
 
 class ImageRGBA;
 
@@ -9,6 +9,8 @@
 
 #include <stb_image.h>
 
+#include "fill.hpp"
+#include "storage.hpp"
 #include "surface.hpp"
 
 #include "../support/error.hpp"
@@ -75,12 +77,16 @@ void blit_masked( Surface& aSurface, ImageRGBA const& aImage, Vec2f aPosition )
 
 	for (int y = y0, image_y = image_y0; y < y1; ++y, ++image_y) {
 
+		// look up the row once: the pixel stores may alias the pitch in the
+		// storage header, which set_pixel_srgb() would reload for each pixel
+		std::uint8_t* const row = surface_row_ptr(aSurface, (Surface::Index)y);
+
 		for (int x = x0, image_x = image_x0; x < x1; ++x, ++image_x) {
 
 			ColorU8_sRGB_Alpha color_of_pixel = aImage.get_pixel((ImageRGBA::Index)image_x, (ImageRGBA::Index)image_y);
 			if (color_of_pixel.a >= 128) { 
-				aSurface.set_pixel_srgb((Surface::Index)x, (Surface::Index)y,
-					ColorU8_sRGB{ color_of_pixel.r, color_of_pixel.g, color_of_pixel.b });
+				std::uint32_t const rgbx = pack_rgbx(ColorU8_sRGB{ color_of_pixel.r, color_of_pixel.g, color_of_pixel.b });
+				std::memcpy(row + 4*x, &rgbx, sizeof(rgbx));
 			}
 		}
 	}
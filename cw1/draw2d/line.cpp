@@ -0,0 +1,1134 @@
+#include "line.hpp"
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+
+#include "cpu.hpp"
+#include "draw.hpp"
+#include "fill.hpp"
+#include "storage.hpp"
+#include "surface.hpp"
+#include "triangle.hpp"
+
+namespace
+{
+	std::int64_t to_line_fixed_( float aValue ) noexcept
+	{
+		// Exact in double for any float in the clip area
+		return std::int64_t(std::floor( double(aValue) * double(kLineSubpixelOne) + 0.5 ));
+	}
+
+	std::int64_t floor_div_( std::int64_t aNum, std::int64_t aDen ) noexcept
+	{
+		std::int64_t const q = aNum / aDen;
+		return (aNum % aDen != 0 && (aNum < 0) != (aDen < 0)) ? q - 1 : q;
+	}
+	std::int64_t ceil_div_( std::int64_t aNum, std::int64_t aDen ) noexcept
+	{
+		return -floor_div_( -aNum, aDen );
+	}
+
+	// Restrict the steps [aFirst, aLast] to those whose minor pixel coordinate
+	// lies in [aMinorBegin, aMinorEnd). The minor coordinate is monotonic, so
+	// this removes a prefix and/or a suffix.
+	void clip_line_minor_( LineSetup const& aSetup, std::int64_t aMinorBegin, std::int64_t aMinorEnd, std::int64_t& aFirst, std::int64_t& aLast ) noexcept
+	{
+		// Valid steps satisfy lower <= start + i*step < upper
+		std::int64_t const lower = aMinorBegin * aSetup.den;
+		std::int64_t const upper = aMinorEnd * aSetup.den;
+
+		if( 0 == aSetup.step )
+		{
+			if( aSetup.start < lower || aSetup.start >= upper )
+				aLast = aFirst - 1;
+		}
+		else if( aSetup.step > 0 )
+		{
+			aFirst = std::max( aFirst, ceil_div_( lower - aSetup.start, aSetup.step ) );
+			aLast = std::min( aLast, ceil_div_( upper - aSetup.start, aSetup.step ) - 1 );
+		}
+		else
+		{
+			aFirst = std::max( aFirst, floor_div_( aSetup.start - upper, -aSetup.step ) + 1 );
+			aLast = std::min( aLast, floor_div_( aSetup.start - lower, -aSetup.step ) );
+		}
+	}
+
+	// Strides (in bytes) for one step along the major and minor axes
+	void line_strides_( Surface const& aSurface, LineSetup const& aSetup, std::ptrdiff_t& aMajorStride, std::ptrdiff_t& aMinorStride ) noexcept
+	{
+		std::ptrdiff_t const pixelStride = 4;
+		std::ptrdiff_t const rowStride = std::ptrdiff_t(surface_pitch( aSurface ));
+
+		aMajorStride = aSetup.xMajor ? pixelStride : rowStride;
+		aMinorStride = aSetup.xMajor ? rowStride : pixelStride;
+	}
+
+	// The only branch in the loop is the minor step. Selecting it with a mask
+	// instead was measurably slower: it lengthens the dependency chain through
+	// rem, and the branch predicts well for shallow and close to diagonal
+	// lines. Note that the walk's members are copied to locals: the pixel
+	// stores go through a byte pointer, which may alias them, and they would
+	// be reloaded otherwise.
+	template< bool tXMajor, int tMajorDir, int tMinorDir >
+	void line_octant_( LineWalk const& aWalk, std::uint32_t aRGBx ) noexcept
+	{
+		std::ptrdiff_t const majorStride = tXMajor ? tMajorDir*4 : tMajorDir*aWalk.rowStride;
+		std::ptrdiff_t const minorStride = tXMajor ? tMinorDir*aWalk.rowStride : tMinorDir*4;
+
+		std::int64_t const step = aWalk.step;
+		std::int64_t const den = aWalk.den;
+		int const count = aWalk.count;
+
+		std::uint8_t* pixel = aWalk.pixel;
+		std::int64_t rem = aWalk.rem;
+
+		for( int i = 0; i < count; ++i )
+		{
+			std::memcpy( pixel, &aRGBx, sizeof(aRGBx) );
+
+			pixel += majorStride;
+			rem += step;
+			if( rem >= den )
+			{
+				rem -= den;
+				pixel += minorStride;
+			}
+		}
+	}
+
+	// See line_octant_(). The front walk moves in the walk's directions, the
+	// back walk in the opposite ones; each has its own remainder.
+	template< bool tXMajor, int tMajorDir, int tMinorDir >
+	void line_octant_symmetric_( LineWalk const& aWalk, std::uint32_t aRGBx ) noexcept
+	{
+		std::ptrdiff_t const majorStride = tXMajor ? tMajorDir*4 : tMajorDir*aWalk.rowStride;
+		std::ptrdiff_t const minorStride = tXMajor ? tMinorDir*aWalk.rowStride : tMinorDir*4;
+
+		std::int64_t const step = aWalk.step;
+		std::int64_t const den = aWalk.den;
+		int const count = aWalk.count;
+
+		// Last pixel and its remainder
+		std::int64_t const num = aWalk.rem + std::int64_t(count-1) * step;
+		std::int64_t const minor = num / den;
+
+		std::uint8_t* front = aWalk.pixel;
+		std::uint8_t* back = aWalk.pixel + std::ptrdiff_t(count-1) * majorStride + std::ptrdiff_t(minor) * minorStride;
+
+		std::int64_t frontRem = aWalk.rem;
+		std::int64_t backRem = den - 1 - (num - minor * den);
+
+		for( int i = 0; i < count/2; ++i )
+		{
+			std::memcpy( front, &aRGBx, sizeof(aRGBx) );
+			std::memcpy( back, &aRGBx, sizeof(aRGBx) );
+
+			front += majorStride;
+			back -= majorStride;
+
+			frontRem += step;
+			if( frontRem >= den )
+			{
+				frontRem -= den;
+				front += minorStride;
+			}
+
+			backRem += step;
+			if( backRem >= den )
+			{
+				backRem -= den;
+				back -= minorStride;
+			}
+		}
+
+		// Middle pixel; the two walks meet here
+		if( count & 1 )
+			std::memcpy( front, &aRGBx, sizeof(aRGBx) );
+	}
+
+	/* Clip an axis-aligned line to aArea, like clip_line() does. The line is
+	 * at aMinor on the minor axis, and spans [aBegin, aEnd] (in either
+	 * order) on the major axis. With no extent on the minor axis, the
+	 * intersections computed by clip_line() are exactly the clamped
+	 * endpoints.
+	 */
+	bool clip_axis_line_( Rect2F const& aArea, bool aHorizontal, float aMinor, float& aBegin, float& aEnd ) noexcept
+	{
+		float const majorMin = aHorizontal ? aArea.xmin : aArea.ymin;
+		float const majorMax = majorMin + (aHorizontal ? aArea.width : aArea.height) - 1.f;
+		float const minorMin = aHorizontal ? aArea.ymin : aArea.xmin;
+		float const minorMax = minorMin + (aHorizontal ? aArea.height : aArea.width) - 1.f;
+
+		if( aMinor < minorMin || aMinor > minorMax )
+			return false;
+		if( (aBegin < majorMin && aEnd < majorMin) || (aBegin > majorMax && aEnd > majorMax) )
+			return false;
+
+		aBegin = std::clamp( aBegin, majorMin, majorMax );
+		aEnd = std::clamp( aEnd, majorMin, majorMax );
+		return true;
+	}
+
+	/* Walk the runs of a line. Calls aRunFn( major, minor, length ) for each
+	 * maximal run of steps that share a minor coordinate, in order.
+	 *
+	 * Runs are computed for an increasing minor coordinate. Lines where it
+	 * decreases are mirrored first: floor((-n-1)/d) = -floor(n/d)-1, so with
+	 * the numerator -n-1 the quotient increases exactly where the original
+	 * one decreases.
+	 *
+	 * The first run's length needs a division. After it, the remainder lies
+	 * in [0, step), and the remaining runs are q or q+1 steps long, where q
+	 * and r are the quotient and remainder of den/step. The run is q+1 long
+	 * if the remainder is below r; this is the classic run-slice error term.
+	 */
+	template< typename tRunFn >
+	void walk_line_runs_( LineSetup const& aSetup, tRunFn&& aRunFn )
+	{
+		bool const down = aSetup.step < 0;
+		std::int64_t const step = down ? -aSetup.step : aSetup.step;
+		std::int64_t const den = aSetup.den;
+
+		std::int64_t const num0 = aSetup.start + std::int64_t(aSetup.first) * aSetup.step;
+		std::int64_t const num = down ? -num0 - 1 : num0;
+
+		std::int64_t const quot = floor_div_( num, den );
+		std::int64_t rem = num - quot * den;
+
+		int minor = int(down ? -quot - 1 : quot);
+		int const minorStep = down ? -1 : 1;
+
+		int major = aSetup.major + aSetup.first;
+		int count = aSetup.last - aSetup.first + 1;
+
+		if( 0 == step )
+		{
+			aRunFn( major, minor, count );
+			return;
+		}
+
+		std::int64_t const runBase = den / step;
+		std::int64_t const runRem = den % step;
+
+		std::int64_t run = ceil_div_( den - rem, step );
+		rem += run * step - den;
+
+		while( count > 0 )
+		{
+			int const length = int(std::min<std::int64_t>( run, count ));
+			aRunFn( major, minor, length );
+
+			major += length;
+			minor += minorStep;
+			count -= length;
+
+			run = runBase + (rem < runRem);
+			rem += run * step - den;
+		}
+	}
+}
+
+bool setup_line( LineSetup& aSetup, Surface const& aSurface, Vec2f aBegin, Vec2f aEnd ) noexcept
+{
+	// clip_line() lets NaNs through (all comparisons are false). Rounding
+	// those would give arbitrary pixel positions.
+	if( !std::isfinite( aBegin.x ) || !std::isfinite( aBegin.y ) || !std::isfinite( aEnd.x ) || !std::isfinite( aEnd.y ) )
+		return false;
+
+	// Only the setup uses floats; see LineSetup for the stepping
+	std::int64_t const beginX = to_line_fixed_( aBegin.x ), beginY = to_line_fixed_( aBegin.y );
+	std::int64_t const endX = to_line_fixed_( aEnd.x ), endY = to_line_fixed_( aEnd.y );
+
+	// Pick the major axis and order the endpoints along it. The axis is
+	// picked from the fixed point extents, which give step and den below.
+	// With (nearly) equal float extents, the rounding can otherwise make the
+	// minor extent one subpixel longer, i.e., |step| > den.
+	bool const xMajor = std::abs( endX - beginX ) >= std::abs( endY - beginY );
+	float const beginMajor = xMajor ? aBegin.x : aBegin.y;
+	float const endMajor = xMajor ? aEnd.x : aEnd.y;
+
+	bool const forward = beginMajor <= endMajor;
+	Vec2f const start = forward ? aBegin : aEnd;
+
+	std::int64_t const startMajor = xMajor ? (forward ? beginX : endX) : (forward ? beginY : endY);
+	std::int64_t const startMinor = xMajor ? (forward ? beginY : endY) : (forward ? beginX : endX);
+	std::int64_t const finishMajor = xMajor ? (forward ? endX : beginX) : (forward ? endY : beginY);
+	std::int64_t const finishMinor = xMajor ? (forward ? endY : beginY) : (forward ? endX : beginX);
+
+	// A zero major extent (after conversion) means a line that is at most
+	// one pixel long; any denominator works for that.
+	std::int64_t const extent = std::max( finishMajor - startMajor, std::int64_t(1) );
+
+	aSetup.den = extent * kLineSubpixelOne;
+	aSetup.step = (finishMinor - startMinor) * kLineSubpixelOne;
+	aSetup.start = extent * (startMinor + kLineSubpixelOne/2);
+
+	aSetup.xMajor = xMajor;
+	aSetup.reversed = !forward;
+	aSetup.major = int(std::lround( xMajor ? start.x : start.y ));
+
+	int const steps = std::abs( int(std::lround( beginMajor - endMajor )) ) + 1;
+
+	// The clipped endpoints may round to a pixel just outside of the surface.
+	// Drop those steps up front instead of testing each pixel.
+	std::int64_t const width = aSurface.get_width();
+	std::int64_t const height = aSurface.get_height();
+
+	std::int64_t first = std::max( 0, -aSetup.major );
+	std::int64_t last = std::min<std::int64_t>( steps, (xMajor ? width : height) - aSetup.major ) - 1;
+	clip_line_minor_( aSetup, 0, xMajor ? height : width, first, last );
+
+	aSetup.first = int(first);
+	aSetup.last = int(last);
+	return first <= last;
+}
+
+bool restrict_line_rows( LineSetup& aSetup, int aRowBegin, int aRowEnd ) noexcept
+{
+	std::int64_t first = aSetup.first;
+	std::int64_t last = aSetup.last;
+
+	if( aSetup.xMajor )
+	{
+		clip_line_minor_( aSetup, aRowBegin, aRowEnd, first, last );
+	}
+	else
+	{
+		first = std::max<std::int64_t>( first, std::int64_t(aRowBegin) - aSetup.major );
+		last = std::min<std::int64_t>( last, std::int64_t(aRowEnd) - 1 - aSetup.major );
+	}
+
+	// If nothing is left, the bounds can lie far outside of the int range
+	if( first > last )
+	{
+		aSetup.last = aSetup.first - 1;
+		return false;
+	}
+
+	aSetup.first = int(first);
+	aSetup.last = int(last);
+	return true;
+}
+
+bool draw_line_axis_aligned( Surface& aSurface, Rect2F const& aClipArea, Vec2f aBegin, Vec2f aEnd, std::uint32_t aRGBx ) noexcept
+{
+	// Points count as horizontal, since setup_line() picks x as the major
+	// axis for ties.
+	bool const horizontal = aBegin.y == aEnd.y;
+	if( !horizontal && aBegin.x != aEnd.x )
+		return false;
+
+	// Infinities turn into NaNs in clip_line(), so that nothing is drawn.
+	if( !std::isfinite( aBegin.x ) || !std::isfinite( aBegin.y ) || !std::isfinite( aEnd.x ) || !std::isfinite( aEnd.y ) )
+		return false;
+
+	float const minor = horizontal ? aBegin.y : aBegin.x;
+	float begin = horizontal ? aBegin.x : aBegin.y;
+	float end = horizontal ? aEnd.x : aEnd.y;
+
+	if( !clip_axis_line_( aClipArea, horizontal, minor, begin, end ) )
+		return true;
+	if( !clip_axis_line_( aSurface.clip_area(), horizontal, minor, begin, end ) )
+		return true;
+
+	// Same rounding as setup_line(); the minor coordinate does not change
+	// along the line.
+	int const majorSize = int(horizontal ? aSurface.get_width() : aSurface.get_height());
+	int const minorSize = int(horizontal ? aSurface.get_height() : aSurface.get_width());
+
+	int const line = int(floor_div_( to_line_fixed_( minor ) + kLineSubpixelOne/2, kLineSubpixelOne ));
+	if( line < 0 || line >= minorSize )
+		return true;
+
+	int const start = int(std::lround( std::min( begin, end ) ));
+	int const steps = std::abs( int(std::lround( begin - end )) ) + 1;
+
+	int const first = std::max( start, 0 );
+	int const last = std::min( start + steps, majorSize ) - 1;
+
+	if( horizontal )
+	{
+		fill_span( surface_row_ptr( aSurface, Surface::Index(line) ), first, last, aRGBx );
+	}
+	else if( first <= last )
+	{
+		std::ptrdiff_t const rowStride = std::ptrdiff_t(surface_pitch( aSurface ));
+		fill_column( surface_row_ptr( aSurface, Surface::Index(first) ) + 4*line, rowStride, last - first + 1, aRGBx );
+	}
+
+	return true;
+}
+
+void line_step_pixel( LineSetup const& aSetup, int aStep, int& aX, int& aY ) noexcept
+{
+	int const major = aSetup.major + aStep;
+	int const minor = int(floor_div_( aSetup.start + std::int64_t(aStep) * aSetup.step, aSetup.den ));
+
+	aX = aSetup.xMajor ? major : minor;
+	aY = aSetup.xMajor ? minor : major;
+}
+
+void rasterize_line_dda( Surface& aSurface, LineSetup const& aSetup, std::uint32_t aRGBx )
+{
+	if( aSetup.first > aSetup.last )
+		return;
+
+	std::ptrdiff_t majorStride, minorStride;
+	line_strides_( aSurface, aSetup, majorStride, minorStride );
+
+	std::int64_t const num = aSetup.start + std::int64_t(aSetup.first) * aSetup.step;
+	std::int64_t const minor = floor_div_( num, aSetup.den );
+	std::int64_t rem = num - minor * aSetup.den;
+
+	std::uint8_t* pixel = surface_row_ptr( aSurface, 0 )
+		+ (aSetup.major + aSetup.first) * majorStride
+		+ minor * minorStride
+	;
+
+	// Locals, since the pixel stores may alias aSetup (see line_octant_())
+	std::int64_t const step = aSetup.step;
+	std::int64_t const den = aSetup.den;
+	int const count = aSetup.last - aSetup.first + 1;
+
+	for( int i = 0; i < count; ++i )
+	{
+		std::memcpy( pixel, &aRGBx, sizeof(aRGBx) );
+
+		pixel += majorStride;
+		rem += step;
+		if( rem >= den )
+		{
+			rem -= den;
+			pixel += minorStride;
+		}
+		else if( rem < 0 )
+		{
+			rem += den;
+			pixel -= minorStride;
+		}
+	}
+}
+
+void rasterize_line_runs( Surface& aSurface, LineSetup const& aSetup, std::uint32_t aRGBx )
+{
+	if( aSetup.first > aSetup.last )
+		return;
+
+	std::uint8_t* const base = surface_row_ptr( aSurface, 0 );
+	std::ptrdiff_t const rowStride = std::ptrdiff_t(surface_pitch( aSurface ));
+
+	if( aSetup.xMajor )
+	{
+		// Horizontal runs. Short runs (steeper lines) are not worth the
+		// call to fill_span().
+		walk_line_runs_( aSetup, [base,rowStride,aRGBx] (int aMajor, int aMinor, int aLength) {
+			std::uint8_t* const row = base + aMinor * rowStride;
+			if( aLength < 8 )
+			{
+				for( int i = 0; i < aLength; ++i )
+					std::memcpy( row + 4*(aMajor+i), &aRGBx, sizeof(aRGBx) );
+			}
+			else
+			{
+				fill_span( row, aMajor, aMajor + aLength - 1, aRGBx );
+			}
+		} );
+	}
+	else
+	{
+		// Vertical runs
+		walk_line_runs_( aSetup, [base,rowStride,aRGBx] (int aMajor, int aMinor, int aLength) {
+			fill_column( base + aMajor * rowStride + 4*aMinor, rowStride, aLength, aRGBx );
+		} );
+	}
+}
+
+void rasterize_line_octants( Surface& aSurface, LineSetup const& aSetup, std::uint32_t aRGBx )
+{
+	if( aSetup.first > aSetup.last )
+		return;
+
+	// Lines where the minor coordinate decreases are mirrored, as in
+	// walk_line_runs_(), so that the remainder always counts up.
+	bool const down = aSetup.step < 0;
+
+	std::int64_t const num0 = aSetup.start + std::int64_t(aSetup.first) * aSetup.step;
+	std::int64_t const num = down ? -num0 - 1 : num0;
+
+	std::int64_t const quot = floor_div_( num, aSetup.den );
+	std::int64_t const minor = down ? -quot - 1 : quot;
+
+	std::ptrdiff_t majorStride, minorStride;
+	line_strides_( aSurface, aSetup, majorStride, minorStride );
+
+	LineWalk walk;
+	walk.pixel = surface_row_ptr( aSurface, 0 )
+		+ (aSetup.major + aSetup.first) * majorStride
+		+ minor * minorStride
+	;
+	walk.rowStride = std::ptrdiff_t(surface_pitch( aSurface ));
+	walk.count = aSetup.last - aSetup.first + 1;
+
+	// setup_line() orders the endpoints along the major axis, so only four
+	// of the octant kernels are used here.
+	walk.xMajor = aSetup.xMajor;
+	walk.majorDir = 1;
+	walk.minorDir = down ? -1 : 1;
+
+	walk.rem = num - quot * aSetup.den;
+	walk.step = down ? -aSetup.step : aSetup.step;
+	walk.den = aSetup.den;
+
+	draw_line_octant( walk, aRGBx );
+}
+
+void draw_line_octant( LineWalk const& aWalk, std::uint32_t aRGBx ) noexcept
+{
+	int const octant = (aWalk.xMajor ? 4 : 0) | (aWalk.majorDir > 0 ? 2 : 0) | (aWalk.minorDir > 0 ? 1 : 0);
+
+	switch( octant )
+	{
+		case 0: return line_octant_<false,-1,-1>( aWalk, aRGBx );
+		case 1: return line_octant_<false,-1,+1>( aWalk, aRGBx );
+		case 2: return line_octant_<false,+1,-1>( aWalk, aRGBx );
+		case 3: return line_octant_<false,+1,+1>( aWalk, aRGBx );
+		case 4: return line_octant_<true,-1,-1>( aWalk, aRGBx );
+		case 5: return line_octant_<true,-1,+1>( aWalk, aRGBx );
+		case 6: return line_octant_<true,+1,-1>( aWalk, aRGBx );
+		case 7: return line_octant_<true,+1,+1>( aWalk, aRGBx );
+	}
+}
+
+void draw_line_octant_symmetric( LineWalk const& aWalk, std::uint32_t aRGBx ) noexcept
+{
+	if( aWalk.count <= 0 )
+		return;
+
+	int const octant = (aWalk.xMajor ? 4 : 0) | (aWalk.majorDir > 0 ? 2 : 0) | (aWalk.minorDir > 0 ? 1 : 0);
+
+	switch( octant )
+	{
+		case 0: return line_octant_symmetric_<false,-1,-1>( aWalk, aRGBx );
+		case 1: return line_octant_symmetric_<false,-1,+1>( aWalk, aRGBx );
+		case 2: return line_octant_symmetric_<false,+1,-1>( aWalk, aRGBx );
+		case 3: return line_octant_symmetric_<false,+1,+1>( aWalk, aRGBx );
+		case 4: return line_octant_symmetric_<true,-1,-1>( aWalk, aRGBx );
+		case 5: return line_octant_symmetric_<true,-1,+1>( aWalk, aRGBx );
+		case 6: return line_octant_symmetric_<true,+1,-1>( aWalk, aRGBx );
+		case 7: return line_octant_symmetric_<true,+1,+1>( aWalk, aRGBx );
+	}
+}
+
+namespace
+{
+	// Same convention as clip_line(): the lines are clipped to the centers
+	// of the surface's edge pixels.
+	struct ClipBounds_
+	{
+		float xmin, ymin;
+		float xmax, ymax;
+	};
+
+	enum class SegmentClass_
+	{
+		reject,
+		accept,
+		clip
+	};
+
+	ClipBounds_ clip_bounds_( Surface const& aSurface ) noexcept
+	{
+		Rect2F const area = aSurface.clip_area();
+		return ClipBounds_{ area.xmin, area.ymin, area.xmin + area.width - 1.f, area.ymin + area.height - 1.f };
+	}
+
+	bool inside_( ClipBounds_ const& aBounds, Vec2f aPoint ) noexcept
+	{
+		return aPoint.x >= aBounds.xmin && aPoint.x <= aBounds.xmax
+			&& aPoint.y >= aBounds.ymin && aPoint.y <= aBounds.ymax;
+	}
+
+	// Scalar version of the outcode test done by classify8_avx2_()
+	SegmentClass_ classify_segment_( ClipBounds_ const& aBounds, LineSegment const& aSegment ) noexcept
+	{
+		Vec2f const p = aSegment.begin, q = aSegment.end;
+		if( inside_( aBounds, p ) && inside_( aBounds, q ) )
+			return SegmentClass_::accept;
+
+		if( (p.x < aBounds.xmin && q.x < aBounds.xmin) || (p.x > aBounds.xmax && q.x > aBounds.xmax)
+			|| (p.y < aBounds.ymin && q.y < aBounds.ymin) || (p.y > aBounds.ymax && q.y > aBounds.ymax) )
+		{
+			return SegmentClass_::reject;
+		}
+
+		return SegmentClass_::clip;
+	}
+
+	/* Liang-Barsky clip. The line is p + t*(q-p); each edge limits t from
+	 * one side. Unlike Cohen-Sutherland, this needs at most four divisions
+	 * and no iteration. Computed in double, so that the extents cannot
+	 * overflow. Returns false if nothing is left; lines with non-finite
+	 * coordinates are never drawn.
+	 */
+	bool clip_line_parametric_( ClipBounds_ const& aBounds, Vec2f& aBegin, Vec2f& aEnd ) noexcept
+	{
+		if( !std::isfinite( aBegin.x ) || !std::isfinite( aBegin.y ) || !std::isfinite( aEnd.x ) || !std::isfinite( aEnd.y ) )
+			return false;
+
+		double const x = aBegin.x, y = aBegin.y;
+		double const dx = double(aEnd.x) - x;
+		double const dy = double(aEnd.y) - y;
+
+		double const p[4] = { -dx, dx, -dy, dy };
+		double const q[4] = {
+			x - aBounds.xmin, aBounds.xmax - x,
+			y - aBounds.ymin, aBounds.ymax - y
+		};
+
+		double t0 = 0., t1 = 1.;
+		for( int i = 0; i < 4; ++i )
+		{
+			if( 0. == p[i] )
+			{
+				// Parallel to the edge, and outside of it?
+				if( q[i] < 0. )
+					return false;
+			}
+			else
+			{
+				double const t = q[i] / p[i];
+				if( p[i] < 0. )
+					t0 = std::max( t0, t );
+				else
+					t1 = std::min( t1, t );
+			}
+		}
+
+		if( t0 > t1 )
+			return false;
+
+		if( t1 < 1. )
+			aEnd = Vec2f{ float(x + t1*dx), float(y + t1*dy) };
+		if( t0 > 0. )
+			aBegin = Vec2f{ float(x + t0*dx), float(y + t0*dy) };
+
+		return true;
+	}
+
+	// Draws the segment's pixels in the rows [aRowBegin, aRowEnd)
+	void draw_segment_( Surface& aSurface, ClipBounds_ const& aBounds, LineSegment const& aSegment, SegmentClass_ aClass, std::uint32_t aRGBx, int aRowBegin, int aRowEnd )
+	{
+		Vec2f begin = aSegment.begin, end = aSegment.end;
+		if( SegmentClass_::reject == aClass )
+			return;
+		if( SegmentClass_::clip == aClass && !clip_line_parametric_( aBounds, begin, end ) )
+			return;
+
+		LineSetup setup;
+		if( !setup_line( setup, aSurface, begin, end ) )
+			return;
+
+		bool const band = aRowBegin > 0 || aRowEnd < int(aSurface.get_height());
+		if( band && !restrict_line_rows( setup, aRowBegin, aRowEnd ) )
+			return;
+
+		rasterize_line( aSurface, setup, aRGBx );
+	}
+}
+
+#if DRAW2D_CFG_ENABLE_AVX2
+namespace
+{
+	static_assert( sizeof(LineSegment) == 4*sizeof(float) );
+
+	/* Classify segments [0,8) of aSegments. Sets bit i of aAccept/aReject if
+	 * segment i is trivially accepted/rejected; see classify_segment_().
+	 *
+	 * Each 256-bit load holds two segments. An in-lane 4x4 transpose gives
+	 * one register per coordinate, with the segments in the order 0, 2, 4, 6
+	 * (low lane) and 1, 3, 5, 7 (high lane). The results are permuted back
+	 * before extracting the masks.
+	 */
+	DRAW2D_TARGET_AVX2
+	void classify8_avx2_( ClipBounds_ const& aBounds, LineSegment const* aSegments, unsigned& aAccept, unsigned& aReject ) noexcept
+	{
+		float const* src = &aSegments[0].begin.x;
+		__m256 const r0 = _mm256_loadu_ps( src + 0 );
+		__m256 const r1 = _mm256_loadu_ps( src + 8 );
+		__m256 const r2 = _mm256_loadu_ps( src + 16 );
+		__m256 const r3 = _mm256_loadu_ps( src + 24 );
+
+		__m256 const t0 = _mm256_unpacklo_ps( r0, r1 );
+		__m256 const t1 = _mm256_unpackhi_ps( r0, r1 );
+		__m256 const t2 = _mm256_unpacklo_ps( r2, r3 );
+		__m256 const t3 = _mm256_unpackhi_ps( r2, r3 );
+
+		__m256 const x0 = _mm256_shuffle_ps( t0, t2, 0x44 );
+		__m256 const y0 = _mm256_shuffle_ps( t0, t2, 0xee );
+		__m256 const x1 = _mm256_shuffle_ps( t1, t3, 0x44 );
+		__m256 const y1 = _mm256_shuffle_ps( t1, t3, 0xee );
+
+		__m256 const xmin = _mm256_set1_ps( aBounds.xmin );
+		__m256 const xmax = _mm256_set1_ps( aBounds.xmax );
+		__m256 const ymin = _mm256_set1_ps( aBounds.ymin );
+		__m256 const ymax = _mm256_set1_ps( aBounds.ymax );
+
+		// Outcode bits per endpoint. Ordered comparisons are false for NaNs,
+		// so those are neither accepted nor rejected.
+		__m256 const left0 = _mm256_cmp_ps( x0, xmin, _CMP_LT_OQ ), left1 = _mm256_cmp_ps( x1, xmin, _CMP_LT_OQ );
+		__m256 const right0 = _mm256_cmp_ps( x0, xmax, _CMP_GT_OQ ), right1 = _mm256_cmp_ps( x1, xmax, _CMP_GT_OQ );
+		__m256 const bottom0 = _mm256_cmp_ps( y0, ymin, _CMP_LT_OQ ), bottom1 = _mm256_cmp_ps( y1, ymin, _CMP_LT_OQ );
+		__m256 const top0 = _mm256_cmp_ps( y0, ymax, _CMP_GT_OQ ), top1 = _mm256_cmp_ps( y1, ymax, _CMP_GT_OQ );
+
+		__m256 const inside0 = _mm256_and_ps(
+			_mm256_and_ps( _mm256_cmp_ps( x0, xmin, _CMP_GE_OQ ), _mm256_cmp_ps( x0, xmax, _CMP_LE_OQ ) ),
+			_mm256_and_ps( _mm256_cmp_ps( y0, ymin, _CMP_GE_OQ ), _mm256_cmp_ps( y0, ymax, _CMP_LE_OQ ) )
+		);
+		__m256 const inside1 = _mm256_and_ps(
+			_mm256_and_ps( _mm256_cmp_ps( x1, xmin, _CMP_GE_OQ ), _mm256_cmp_ps( x1, xmax, _CMP_LE_OQ ) ),
+			_mm256_and_ps( _mm256_cmp_ps( y1, ymin, _CMP_GE_OQ ), _mm256_cmp_ps( y1, ymax, _CMP_LE_OQ ) )
+		);
+
+		__m256 const accept = _mm256_and_ps( inside0, inside1 );
+		__m256 const reject = _mm256_or_ps(
+			_mm256_or_ps( _mm256_and_ps( left0, left1 ), _mm256_and_ps( right0, right1 ) ),
+			_mm256_or_ps( _mm256_and_ps( bottom0, bottom1 ), _mm256_and_ps( top0, top1 ) )
+		);
+
+		__m256i const order = _mm256_setr_epi32( 0, 4, 1, 5, 2, 6, 3, 7 );
+		aAccept = unsigned(_mm256_movemask_ps( _mm256_permutevar8x32_ps( accept, order ) ));
+		aReject = unsigned(_mm256_movemask_ps( _mm256_permutevar8x32_ps( reject, order ) ));
+	}
+}
+#endif // ~ ENABLE_AVX2
+
+void draw_lines_solid( Surface& aSurface, std::span<LineSegment const> aSegments, ColorU8_sRGB aColor )
+{
+	ClipBounds_ const bounds = clip_bounds_( aSurface );
+	std::uint32_t const rgbx = pack_rgbx( aColor );
+	int const height = int(aSurface.get_height());
+
+	std::size_t i = 0;
+
+#	if DRAW2D_CFG_ENABLE_AVX2
+	if( cpu_has_avx2() )
+	{
+		for( ; i + 8 <= aSegments.size(); i += 8 )
+		{
+			unsigned accept, reject;
+			classify8_avx2_( bounds, aSegments.data() + i, accept, reject );
+
+			// Entire batch outside?
+			if( 0xff == reject )
+				continue;
+
+			for( unsigned j = 0; j < 8; ++j )
+			{
+				SegmentClass_ const cls = (accept >> j) & 1 ? SegmentClass_::accept
+					: (reject >> j) & 1 ? SegmentClass_::reject
+					: SegmentClass_::clip
+				;
+				draw_segment_( aSurface, bounds, aSegments[i+j], cls, rgbx, 0, height );
+			}
+		}
+	}
+#	endif // ~ ENABLE_AVX2
+
+	for( ; i < aSegments.size(); ++i )
+		draw_segment_( aSurface, bounds, aSegments[i], classify_segment_( bounds, aSegments[i] ), rgbx, 0, height );
+}
+
+void draw_lines_solid_banded( Surface& aSurface, std::span<LineSegment const> aSegments, ColorU8_sRGB aColor, unsigned aBands )
+{
+	int const height = int(aSurface.get_height());
+
+	if( 0 == aBands )
+		aBands = std::max( 1u, std::thread::hardware_concurrency() );
+
+	int const bands = int(std::min<unsigned>( aBands, unsigned(std::max( height, 1 )) ));
+	if( bands <= 1 )
+		return draw_lines_solid( aSurface, aSegments, aColor );
+
+	ClipBounds_ const bounds = clip_bounds_( aSurface );
+	std::uint32_t const rgbx = pack_rgbx( aColor );
+
+	auto const draw_band = [&] (int aBand) {
+		int const rowBegin = int(std::int64_t(height) * aBand / bands);
+		int const rowEnd = int(std::int64_t(height) * (aBand+1) / bands);
+
+		// A line only sets pixels in the rows between its rounded endpoints.
+		// Skip lines that are entirely above or below the band, with a bit
+		// of margin for the rounding. (NaNs are not skipped here, but are
+		// rejected by the clip.)
+		float const lower = float(rowBegin) - 1.f;
+		float const upper = float(rowEnd) + 1.f;
+
+		for( auto const& segment : aSegments )
+		{
+			if( segment.begin.y < lower && segment.end.y < lower )
+				continue;
+			if( segment.begin.y > upper && segment.end.y > upper )
+				continue;
+
+			draw_segment_( aSurface, bounds, segment, classify_segment_( bounds, segment ), rgbx, rowBegin, rowEnd );
+		}
+	};
+
+	std::vector<std::jthread> workers;
+	workers.reserve( bands - 1 );
+	for( int band = 1; band < bands; ++band )
+		workers.emplace_back( draw_band, band );
+
+	draw_band( 0 );
+	// ~jthread() joins the workers
+}
+
+namespace
+{
+	// The wide line's rectangle, as four edge functions; see TriangleSetup.
+	struct WideLineSetup_
+	{
+		std::int64_t edge[4];
+		std::int64_t edgeDx[4];
+		std::int64_t edgeDy[4];
+
+		int xmin, xmax;
+		int ymin, ymax;
+	};
+
+	// Same conventions as setup_triangle_edges(), for a convex quad
+	bool setup_wide_line_( WideLineSetup_& aSetup, Surface const& aSurface, Vec2f const (&aCorners)[4] ) noexcept
+	{
+		for( Vec2f const& p : aCorners )
+		{
+			if( !(std::abs( p.x ) <= kTriangleMaxCoord && std::abs( p.y ) <= kTriangleMaxCoord) )
+				return false;
+		}
+
+		bound_box_for_triangle box{
+			std::min( { aCorners[0].x, aCorners[1].x, aCorners[2].x, aCorners[3].x } ),
+			std::max( { aCorners[0].x, aCorners[1].x, aCorners[2].x, aCorners[3].x } ),
+			std::min( { aCorners[0].y, aCorners[1].y, aCorners[2].y, aCorners[3].y } ),
+			std::max( { aCorners[0].y, aCorners[1].y, aCorners[2].y, aCorners[3].y } )
+		};
+		clamping_box( box, aSurface );
+
+		if( box.xmax < box.xmin || box.ymax < box.ymin )
+			return false;
+
+		aSetup.xmin = int(box.xmin);
+		aSetup.xmax = int(box.xmax);
+		aSetup.ymin = int(box.ymin);
+		aSetup.ymax = int(box.ymax);
+
+		std::int64_t x[4], y[4];
+		for( int i = 0; i < 4; ++i )
+		{
+			x[i] = snap_triangle_coord( aCorners[i].x );
+			y[i] = snap_triangle_coord( aCorners[i].y );
+		}
+
+		return setup_convex_edges<4>( x, y, aSetup.xmin, aSetup.ymin, aSetup.edge, aSetup.edgeDx, aSetup.edgeDy );
+	}
+}
+
+void draw_line_wide( Surface& aSurface, Vec2f aBegin, Vec2f aEnd, float aWidth, ColorU8_sRGB aColor )
+{
+	// Written such that NaNs are rejected
+	if( !(aWidth > 0.f) || !std::isfinite( aWidth ) )
+		return;
+
+	// Parts of the line that are further than half the width (plus a pixel,
+	// for the rounding) outside of the surface cannot cover any pixels.
+	float const pad = 0.5f * aWidth + 1.f;
+
+	Rect2F const area = aSurface.clip_area();
+	Rect2F const padded{ area.xmin - pad, area.ymin - pad, area.width + 2.f*pad, area.height + 2.f*pad };
+
+	if( !clip_line( padded, aBegin, aEnd ) )
+		return;
+
+	// clip_line() lets NaNs through
+	if( !std::isfinite( aBegin.x ) || !std::isfinite( aBegin.y ) || !std::isfinite( aEnd.x ) || !std::isfinite( aEnd.y ) )
+		return;
+
+	// Offset to the sides of the line, in double, so that short lines keep
+	// their width
+	double const dx = double(aEnd.x) - aBegin.x;
+	double const dy = double(aEnd.y) - aBegin.y;
+	double const length = std::sqrt( dx*dx + dy*dy );
+	if( 0. == length )
+		return;
+
+	double const scale = 0.5 * aWidth / length;
+	Vec2f const side{ float(-dy * scale), float(dx * scale) };
+
+	Vec2f const corners[4] = { aBegin + side, aEnd + side, aEnd - side, aBegin - side };
+
+	WideLineSetup_ setup;
+	if( !setup_wide_line_( setup, aSurface, corners ) )
+		return;
+
+	std::uint32_t const rgbx = pack_rgbx( aColor );
+	std::int64_t row[4] = { setup.edge[0], setup.edge[1], setup.edge[2], setup.edge[3] };
+
+	for( int y = setup.ymin; y <= setup.ymax; ++y )
+	{
+		int begin, end;
+		if( convex_row_span<4>( row, setup.edgeDx, setup.xmin, setup.xmax, begin, end ) )
+			fill_span( surface_row_ptr( aSurface, Surface::Index(y) ), begin, end, rgbx );
+
+		for( int i = 0; i < 4; ++i )
+			row[i] += setup.edgeDy[i];
+	}
+}
+
+namespace
+{
+	// Addressing of the pixels of an anti-aliased line; see draw_line_aa()
+	struct AaLine_
+	{
+		SrgbTables const& tables;
+		float color[3]; // linear
+
+		std::uint8_t* origin; // pixel (0,0)
+		std::ptrdiff_t majorStride, minorStride;
+		int majorSize, minorSize;
+
+		// Pointer to a pixel, or null if it is outside of the surface
+		std::uint8_t* pixel( int aMajor, int aMinor ) const noexcept
+		{
+			if( aMajor < 0 || aMajor >= majorSize || aMinor < 0 || aMinor >= minorSize )
+				return nullptr;
+
+			return origin + aMajor * majorStride + aMinor * minorStride;
+		}
+	};
+
+	float fract_( float aValue ) noexcept
+	{
+		return aValue - std::floor( aValue );
+	}
+
+	// Blend the pixel at aPixel (if not null) with the line's color
+	void aa_blend_( AaLine_ const& aLine, std::uint8_t* aPixel, float aCoverage ) noexcept
+	{
+		if( !aPixel )
+			return;
+
+		for( int c = 0; c < 3; ++c )
+		{
+			float const dst = aLine.tables.decode[aPixel[c]];
+			float const value = dst + aCoverage * (aLine.color[c] - dst);
+
+			// Same as the LUT mode of linear_to_srgb(); value is in [0,1]
+			int const cell = std::min( int(value * float(kSrgbLutSize)), kSrgbLutSize-1 );
+			int const base = aLine.tables.base[cell];
+			aPixel[c] = std::uint8_t(base + (value >= aLine.tables.threshold[base+1]));
+		}
+	}
+
+	// Interior steps [aBegin, aEnd] of the line, which lie inside of the
+	// surface along the major axis. The minor coordinate is evaluated
+	// relative to step aFirst (which is at aAt0) instead of being
+	// accumulated, so that errors do not build up.
+	void aa_interior_( AaLine_ const& aLine, float aAt0, float aGradient, int aFirst, int aBegin, int aEnd ) noexcept
+	{
+		for( int major = aBegin; major <= aEnd; ++major )
+		{
+			float const minor = aAt0 + aGradient * float(major - aFirst);
+			float const below = std::floor( minor );
+			float const weight = minor - below;
+
+			aa_blend_( aLine, aLine.pixel( major, int(below) ), 1.f - weight );
+			aa_blend_( aLine, aLine.pixel( major, int(below) + 1 ), weight );
+		}
+	}
+
+#	if DRAW2D_CFG_ENABLE_AVX2
+	/* As aa_blend_(), for eight pixels at once. Each lane holds one pixel, and
+	 * the channels are blended one after the other, so that each table lookup
+	 * is a single gather for all eight pixels. Null pixels are redirected to
+	 * a scratch pixel, so that all loads and stores are unconditional. (With
+	 * conditional ones, compilers may turn the loads into a much slower
+	 * gather.) The padding byte is written as zero.
+	 */
+	DRAW2D_TARGET_AVX2
+	void aa_blend8_avx2_( AaLine_ const& aLine, std::uint8_t* const (&aPixels)[8], __m256 aCoverage ) noexcept
+	{
+		std::uint32_t scratch[8] = {};
+
+		std::uint8_t* pixel[8];
+		for( int i = 0; i < 8; ++i )
+			pixel[i] = aPixels[i] ? aPixels[i] : reinterpret_cast<std::uint8_t*>(&scratch[i]);
+
+		auto const load2 = [&pixel] (int aI) {
+			return _mm_unpacklo_epi32( _mm_loadu_si32( pixel[aI] ), _mm_loadu_si32( pixel[aI+1] ) );
+		};
+
+		__m256i const pixels = _mm256_setr_m128i(
+			_mm_unpacklo_epi64( load2( 0 ), load2( 2 ) ),
+			_mm_unpacklo_epi64( load2( 4 ), load2( 6 ) )
+		);
+		__m256i const byte = _mm256_set1_epi32( 0xff );
+
+		__m256i result = _mm256_setzero_si256();
+		for( int c = 0; c < 3; ++c )
+		{
+			__m256i const bytes = _mm256_and_si256( _mm256_srli_epi32( pixels, 8*c ), byte );
+			__m256 const value = _mm256_i32gather_ps( aLine.tables.decode, bytes, 4 );
+
+			__m256 const blended = _mm256_add_ps( value, _mm256_mul_ps( aCoverage, _mm256_sub_ps( _mm256_set1_ps( aLine.color[c] ), value ) ) );
+			result = _mm256_or_si256( result, _mm256_slli_epi32( srgb_encode_lut_avx2( blended, aLine.tables ), 8*c ) );
+		}
+
+		__m128i const lo = _mm256_castsi256_si128( result );
+		__m128i const hi = _mm256_extracti128_si256( result, 1 );
+
+		_mm_storeu_si32( pixel[0], lo );
+		_mm_storeu_si32( pixel[1], _mm_srli_si128( lo, 4 ) );
+		_mm_storeu_si32( pixel[2], _mm_srli_si128( lo, 8 ) );
+		_mm_storeu_si32( pixel[3], _mm_srli_si128( lo, 12 ) );
+		_mm_storeu_si32( pixel[4], hi );
+		_mm_storeu_si32( pixel[5], _mm_srli_si128( hi, 4 ) );
+		_mm_storeu_si32( pixel[6], _mm_srli_si128( hi, 8 ) );
+		_mm_storeu_si32( pixel[7], _mm_srli_si128( hi, 12 ) );
+	}
+
+	// As aa_interior_(), four steps (eight pixels) at a time. The last batch
+	// is padded with null pixels.
+	DRAW2D_TARGET_AVX2
+	void aa_interior_avx2_( AaLine_ const& aLine, float aAt0, float aGradient, int aFirst, int aBegin, int aEnd ) noexcept
+	{
+		for( int major = aBegin; major <= aEnd; major += 4 )
+		{
+			std::uint8_t* pixels[8];
+			float weight[4];
+
+			for( int i = 0; i < 4; ++i )
+			{
+				float const minor = aAt0 + aGradient * float(major + i - aFirst);
+				float const below = std::floor( minor );
+				weight[i] = minor - below;
+
+				bool const inside = major + i <= aEnd;
+				pixels[2*i+0] = inside ? aLine.pixel( major + i, int(below) ) : nullptr;
+				pixels[2*i+1] = inside ? aLine.pixel( major + i, int(below) + 1 ) : nullptr;
+			}
+
+			__m256 const coverage = _mm256_setr_ps(
+				1.f - weight[0], weight[0], 1.f - weight[1], weight[1],
+				1.f - weight[2], weight[2], 1.f - weight[3], weight[3]
+			);
+
+			aa_blend8_avx2_( aLine, pixels, coverage );
+		}
+	}
+
+	// The endpoint pixels aPixels with coverage aCoverage; see draw_line_aa()
+	DRAW2D_TARGET_AVX2
+	void aa_endpoints_avx2_( AaLine_ const& aLine, std::uint8_t* const (&aPixels)[4], float const (&aCoverage)[4] ) noexcept
+	{
+		std::uint8_t* const pixels[8] = { aPixels[0], aPixels[1], aPixels[2], aPixels[3] };
+		__m256 const coverage = _mm256_setr_ps( aCoverage[0], aCoverage[1], aCoverage[2], aCoverage[3], 0.f, 0.f, 0.f, 0.f );
+		aa_blend8_avx2_( aLine, pixels, coverage );
+	}
+#	endif // ~ ENABLE_AVX2
+
+	// Blend the endpoint pixels. The two endpoints share their pixels if the
+	// line is shorter than a pixel; the second one then blends on top of the
+	// first one.
+	void aa_endpoints_( AaLine_ const& aLine, std::uint8_t* const (&aPixels)[4], float const (&aCoverage)[4], bool aShared ) noexcept
+	{
+#		if DRAW2D_CFG_ENABLE_AVX2
+		if( cpu_has_avx2() && !aShared )
+			return aa_endpoints_avx2_( aLine, aPixels, aCoverage );
+#		endif // ~ ENABLE_AVX2
+
+		for( int i = 0; i < 4; ++i )
+			aa_blend_( aLine, aPixels[i], aCoverage[i] );
+	}
+}
+
+void draw_line_aa( Surface& aSurface, Vec2f aBegin, Vec2f aEnd, ColorU8_sRGB aColor )
+{
+	Rect2F const area = aSurface.clip_area();
+	Rect2F const grown{ area.xmin - 1.f, area.ymin - 1.f, area.width + 2.f, area.height + 2.f };
+
+	if( !clip_line( grown, aBegin, aEnd ) )
+		return;
+
+	// clip_line() lets NaNs through
+	if( !std::isfinite( aBegin.x ) || !std::isfinite( aBegin.y ) || !std::isfinite( aEnd.x ) || !std::isfinite( aEnd.y ) )
+		return;
+
+	SrgbTables const& tables = srgb_tables();
+
+	bool const steep = std::fabs( aEnd.y - aBegin.y ) > std::fabs( aEnd.x - aBegin.x );
+	std::ptrdiff_t const rowStride = std::ptrdiff_t(surface_pitch( aSurface ));
+
+	AaLine_ const line{
+		tables,
+		{ tables.decode[aColor.r], tables.decode[aColor.g], tables.decode[aColor.b] },
+		surface_row_ptr( aSurface, 0 ),
+		steep ? rowStride : 4,
+		steep ? 4 : rowStride,
+		int(steep ? aSurface.get_height() : aSurface.get_width()),
+		int(steep ? aSurface.get_width() : aSurface.get_height())
+	};
+
+	// Major and minor coordinates, ordered along the major axis
+	float major0 = steep ? aBegin.y : aBegin.x, minor0 = steep ? aBegin.x : aBegin.y;
+	float major1 = steep ? aEnd.y : aEnd.x, minor1 = steep ? aEnd.x : aEnd.y;
+	if( major0 > major1 )
+	{
+		std::swap( major0, major1 );
+		std::swap( minor0, minor1 );
+	}
+
+	float const extent = major1 - major0;
+	float const gradient = 0.f == extent ? 1.f : (minor1 - minor0) / extent;
+
+	// Endpoints. Pixel centers are at integer coordinates, as for
+	// draw_line_solid(). gap is the fraction of the endpoint's pixel that
+	// the line covers along the major axis.
+	float const end0 = std::floor( major0 + 0.5f );
+	float const at0 = minor0 + gradient * (end0 - major0);
+	float const gap0 = 1.f - fract_( major0 + 0.5f );
+
+	float const end1 = std::floor( major1 + 0.5f );
+	float const at1 = minor1 + gradient * (end1 - major1);
+	float const gap1 = fract_( major1 + 0.5f );
+
+	int const first = int(end0), firstMinor = int(std::floor( at0 ));
+	int const last = int(end1), lastMinor = int(std::floor( at1 ));
+
+	std::uint8_t* const endpoints[4] = {
+		line.pixel( first, firstMinor ), line.pixel( first, firstMinor + 1 ),
+		line.pixel( last, lastMinor ), line.pixel( last, lastMinor + 1 )
+	};
+	float const coverage[4] = {
+		(1.f - fract_( at0 )) * gap0, fract_( at0 ) * gap0,
+		(1.f - fract_( at1 )) * gap1, fract_( at1 ) * gap1
+	};
+	aa_endpoints_( line, endpoints, coverage, first == last );
+
+	// Interior pixels. The clip leaves at most one step outside of the
+	// surface on either end.
+	int const begin = std::max( first + 1, 0 );
+	int const end = std::min( last - 1, line.majorSize - 1 );
+
+#	if DRAW2D_CFG_ENABLE_AVX2
+	if( cpu_has_avx2() )
+		return aa_interior_avx2_( line, at0, gradient, first, begin, end );
+#	endif // ~ ENABLE_AVX2
+
+	aa_interior_( line, at0, gradient, first, begin, end );
+}
@@ -0,0 +1,263 @@
+#ifndef LINE_HPP_5C2E8F4A_7B1D_4E36_9A0C_3D8B6F21E947
+#define LINE_HPP_5C2E8F4A_7B1D_4E36_9A0C_3D8B6F21E947
+
+// Line rasterization internals. draw_clip_line_solid() is a thin wrapper
+// around the functions declared here. Also declares draw_lines_solid(), which
+// draws many lines in one call.
+
+#include <span>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "forward.hpp"
+#include "rect.hpp"
+#include "color.hpp"
+
+#include "../vmlib/vec2.hpp"
+
+/* Compile-time configuration:
+ * Pick the kernel used by draw_clip_line_solid(). DDA steps along the major
+ * axis one pixel at a time, and moves to the next row (column) when the minor
+ * coordinate changes. RUNS (run-slice) instead computes the length of each
+ * run of pixels that share a minor coordinate, and fills whole runs at once:
+ * horizontal runs of x-major lines with fill_span(), vertical runs of y-major
+ * lines by stepping the row stride. OCTANTS is the DDA, with a separate
+ * inner loop for each octant (see draw_line_octant()). RUNS falls back to the
+ * octant kernels for lines whose runs are mostly a single pixel long (slopes
+ * above 1/2). All produce identical results; the functions for each are
+ * declared below, so that they can be compared directly.
+ */
+#define DRAW2D_CFG_LINE_DDA 1
+#define DRAW2D_CFG_LINE_RUNS 2
+#define DRAW2D_CFG_LINE_OCTANTS 3
+
+#define DRAW2D_CFG_LINE_MODE DRAW2D_CFG_LINE_RUNS
+
+/* Line endpoints are converted to a fixed point grid with this many
+ * fractional bits. Unlike triangles, lines do not snap to a coarse grid: the
+ * pixels should match stepping the line with exact arithmetic, and 1/256th of
+ * a pixel changes the selected pixel on a noticeable fraction of lines.
+ */
+constexpr int kLineSubpixelBits = 16;
+constexpr std::int64_t kLineSubpixelOne = std::int64_t(1) << kLineSubpixelBits;
+
+/** Line setup
+ *
+ * Per-line data computed once by setup_line(). Step i of the line sets the
+ * pixel at major coordinate major+i and minor coordinate
+ *
+ *   floor( (start + i*step) / den )
+ *
+ * i.e., the minor coordinate of the line at that step, rounded to the nearest
+ * pixel. With the minor coordinate M0 at the start of the line, and the major
+ * and minor extents D and S, all in fixed point, start = D*(M0 + one/2),
+ * step = S*one and den = D*one. Since |S| <= D, the minor coordinate changes
+ * by at most one per step. The numerators stay well within 64 bits for
+ * surfaces up to 16k x 16k pixels.
+ *
+ * Only the steps [first, last] are drawn; these are the ones that lie inside
+ * of the surface.
+ */
+struct LineSetup
+{
+	std::int64_t start; // numerator at step zero
+	std::int64_t step; // numerator increment per step
+	std::int64_t den; // denominator, positive
+
+	int major; // major pixel coordinate of step zero
+	int first, last; // inclusive range of steps to draw
+
+	bool xMajor; // true if x is the major axis
+	bool reversed; // true if step zero is at aEnd (see setup_line())
+};
+
+/** Set up a line for rasterization
+ *
+ * The endpoints must lie inside of the surface's clip area (see clip_line()).
+ * The major axis is the one with the larger fixed point extent (x for ties),
+ * so |S| <= D holds even when rounding makes nearly diagonal lines' extents
+ * differ. Pixels are selected like stepping a floating point accumulator: the
+ * line starts at the rounded major coordinate of the endpoint with the
+ * smaller one, and takes one step per pixel of the rounded major extent.
+ * Steps that round to a pixel outside of the surface are dropped.
+ *
+ * Returns false if no pixels remain, or if any coordinate is not finite.
+ */
+bool setup_line( LineSetup&, Surface const&, Vec2f aBegin, Vec2f aEnd ) noexcept;
+
+// Restrict the steps of the line to those that set pixels in the rows
+// [aRowBegin, aRowEnd). Returns false if no steps remain.
+bool restrict_line_rows( LineSetup&, int aRowBegin, int aRowEnd ) noexcept;
+
+// Pixel set by step aStep of the line. The step does not need to lie in
+// [first, last].
+void line_step_pixel( LineSetup const&, int aStep, int& aX, int& aY ) noexcept;
+
+/** Rasterize a line that was set up with setup_line()
+ *
+ * Uses the kernel selected by DRAW2D_CFG_LINE_MODE. Pixels are set to the
+ * packed color aRGBx (see pack_rgbx() in fill.hpp).
+ */
+void rasterize_line( Surface&, LineSetup const&, std::uint32_t aRGBx );
+
+/** Draw an exactly horizontal or vertical line
+ *
+ * If aBegin and aEnd have the same y (or x) coordinate, clips the line to
+ * aClipArea and then to the surface's clip area, and draws it, returning
+ * true. The clips reduce to clamping the endpoints to an interval, and the
+ * pixels form a single row (filled with fill_span()) or column (filled with
+ * fill_column()). Produces the same pixels as clip_line() followed by
+ * setup_line() and rasterize_line().
+ *
+ * Returns false, without drawing anything, for all other lines, and for
+ * lines with non-finite coordinates.
+ */
+bool draw_line_axis_aligned( Surface&, Rect2F const& aClipArea, Vec2f aBegin, Vec2f aEnd, std::uint32_t aRGBx ) noexcept;
+
+// Step one pixel at a time.
+void rasterize_line_dda( Surface&, LineSetup const&, std::uint32_t aRGBx );
+
+// Fill whole runs of pixels that share a minor coordinate.
+void rasterize_line_runs( Surface&, LineSetup const&, std::uint32_t aRGBx );
+
+// Step one pixel at a time with the octant's kernel (see draw_line_octant()).
+void rasterize_line_octants( Surface&, LineSetup const&, std::uint32_t aRGBx );
+
+/** Octant-specialized line kernel
+ *
+ * Writes count pixels, starting at pixel. After each pixel, the position
+ * moves one pixel along the major axis in the direction majorDir. rem is
+ * incremented by step; when it reaches den, den is subtracted and the
+ * position moves one pixel along the minor axis in the direction minorDir.
+ * This is the DDA of LineSetup with the direction of the minor axis pulled
+ * out, and also Bresenham's error term (with rem = dx-1-err).
+ *
+ * Requires 0 <= rem < den and 0 <= step <= den. There is no clipping; all
+ * pixels must lie inside of the surface.
+ *
+ * Each of the eight combinations of major axis and directions has its own
+ * instantiation of the inner loop, where the pixel strides and the row
+ * stride's sign are compile-time constants. The choice is made once per
+ * line.
+ */
+struct LineWalk
+{
+	std::uint8_t* pixel; // first pixel
+	std::ptrdiff_t rowStride; // bytes per row, positive
+	int count;
+
+	bool xMajor;
+	int majorDir, minorDir; // +1 or -1
+
+	std::int64_t rem, step, den;
+};
+
+void draw_line_octant( LineWalk const&, std::uint32_t aRGBx ) noexcept;
+
+/** Symmetric double-step line kernel
+ *
+ * Writes the same pixels as draw_line_octant(), but walks from both ends of
+ * the line towards the middle, setting two pixels per iteration. This halves
+ * the number of loop iterations (in the style of Wu's symmetric double-step).
+ *
+ * Walking backwards is the same DDA in the opposite directions: with the
+ * remainder r at the last pixel, the backward walk starts at den-1-r. Both
+ * walks step the minor axis exactly where the forward walk does.
+ */
+void draw_line_octant_symmetric( LineWalk const&, std::uint32_t aRGBx ) noexcept;
+
+/** Symmetric double-step variant of draw_ex_line_solid()
+ *
+ * Sets the same pixels as draw_ex_line_solid(), using
+ * draw_line_octant_symmetric(). Declared here since draw-ex.hpp may not be
+ * changed; defined in draw-ex.cpp.
+ */
+void draw_ex_line_solid_symmetric( SurfaceEx&, Vec2f aBegin, Vec2f aEnd, ColorU8_sRGB );
+
+/** Draw many lines with a single color
+ *
+ * Draws each segment like draw_line_solid() does, but classifies eight
+ * segments at once against the surface's clip area with AVX2 (if the CPU
+ * supports it). Segments with both endpoints inside are drawn without any
+ * clipping; segments with both endpoints beyond the same edge are skipped.
+ * Only the remaining segments are clipped, using the parametric
+ * (Liang-Barsky) clip instead of clip_line().
+ *
+ * Segments that are not clipped produce exactly the same pixels as
+ * draw_line_solid(). For clipped segments, the clipped endpoints can differ
+ * in the last bits from the ones computed by clip_line(), which occasionally
+ * moves a pixel.
+ */
+struct LineSegment
+{
+	Vec2f begin, end;
+};
+
+void draw_lines_solid( Surface&, std::span<LineSegment const> aSegments, ColorU8_sRGB aColor );
+
+/** Draw many lines with a single color, using multiple threads
+ *
+ * Splits the surface into aBands horizontal bands of (roughly) equal height,
+ * and draws each band on its own thread; the calling thread draws the first
+ * band. Each thread goes through all segments, skips those that cannot reach
+ * its band, and draws only the pixels in its rows. Threads never write to
+ * the same pixels, so no locking is needed.
+ *
+ * The lines are not clipped to the bands. Instead, each line is set up once
+ * against the whole surface, and its steps are restricted to the band's rows
+ * (restrict_line_rows()). Lines that cross a band boundary are therefore
+ * drawn with the same pixels as by draw_lines_solid().
+ *
+ * With aBands = 0, one band per hardware thread is used. Threads are
+ * started for each call, so this only pays off for large batches.
+ */
+void draw_lines_solid_banded( Surface&, std::span<LineSegment const> aSegments, ColorU8_sRGB aColor, unsigned aBands = 0 );
+
+/** Draw a wide line
+ *
+ * Draws the rectangle of width aWidth centered on the line from aBegin to
+ * aEnd, with square (butt) ends at the endpoints. The rectangle is
+ * rasterized directly, filling one span per row, instead of drawing several
+ * thin lines side by side.
+ *
+ * Pixels are covered like triangles (see triangle.hpp): a pixel is set if
+ * its center lies inside of the rectangle, and the top-left rule decides for
+ * centers that lie exactly on an edge. Consecutive segments of a polyline
+ * therefore do not overlap along their shared end. The corners are snapped
+ * to the triangle's fixed point grid.
+ *
+ * The line is first clipped with clip_line() against the surface's clip area
+ * grown by half of the width, which drops the parts that cannot touch the
+ * surface. Nothing is drawn for zero-length lines, non-positive widths, and
+ * non-finite values.
+ */
+void draw_line_wide( Surface&, Vec2f aBegin, Vec2f aEnd, float aWidth, ColorU8_sRGB );
+
+/** Draw an anti-aliased line
+ *
+ * Uses Wu's algorithm: at each step along the major axis, the line covers
+ * the two pixels closest to it on the minor axis, weighted by the distance
+ * to each. The endpoints are additionally weighted by how much of their
+ * pixel the line covers along the major axis.
+ *
+ * The color is blended with the existing pixels in linear light. Pixels are
+ * decoded with SrgbTables::decode, and the result is encoded with the LUT
+ * (see SrgbTables), regardless of DRAW2D_CFG_SRGB_MODE, so there are no
+ * calls to std::pow() per pixel. With AVX2, the interior steps and the
+ * endpoint pixels go through the same 8-lane blend, four steps at a time.
+ *
+ * Cost: every step reads, blends and writes two pixels, and the blend needs
+ * table lookups for each channel. This is about 40 ns per major step, or
+ * some 100x an aliased line of the same length. The function is meant for
+ * a modest number of lines where quality matters (outlines, UI elements),
+ * not for bulk line drawing; use draw_line_solid() for the latter.
+ *
+ * The line is clipped with clip_line() against the surface's clip area
+ * grown by one pixel, so that the partially covered pixels along the edges
+ * of the surface are kept.
+ */
+void draw_line_aa( Surface&, Vec2f aBegin, Vec2f aEnd, ColorU8_sRGB );
+
+#include "line.inl"
+#endif // LINE_HPP_5C2E8F4A_7B1D_4E36_9A0C_3D8B6F21E947
@@ -0,0 +1,16 @@
+inline
+void rasterize_line( Surface& aSurface, LineSetup const& aSetup, std::uint32_t aRGBx )
+{
+#	if DRAW2D_CFG_LINE_MODE == DRAW2D_CFG_LINE_DDA
+	rasterize_line_dda( aSurface, aSetup, aRGBx );
+#	elif DRAW2D_CFG_LINE_MODE == DRAW2D_CFG_LINE_RUNS
+	// Close to diagonal, most runs are a single pixel long, and stepping per
+	// pixel is faster. Both kernels produce the same pixels.
+	if( 2*aSetup.step > aSetup.den || 2*aSetup.step < -aSetup.den )
+		return rasterize_line_octants( aSurface, aSetup, aRGBx );
+
+	rasterize_line_runs( aSurface, aSetup, aRGBx );
+#	elif DRAW2D_CFG_LINE_MODE == DRAW2D_CFG_LINE_OCTANTS
+	rasterize_line_octants( aSurface, aSetup, aRGBx );
+#	endif // ~ DRAW2D_CFG_LINE_MODE
+}
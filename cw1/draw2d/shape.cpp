@@ -1,13 +1,310 @@
 #include "shape.hpp"
 
+#include <vector>
 #include <utility>
+#include <algorithm>
 
+#include <cmath>
 #include <cassert>
 #include <cstring>
 
 #include "draw.hpp"
+#include "fill.hpp"
 #include "color.hpp"
+#include "line.hpp"
+#include "tiled.hpp"
 #include "surface.hpp"
+#include "triangle.hpp"
+
+namespace
+{
+	// Segments per chunk of a LineStrip. Each chunk's bounding box is tested
+	// once per draw; large enough that this is cheap relative to drawing the
+	// segments, small enough to skip off-screen parts of long strips.
+	constexpr std::size_t kLineStripChunkSize = 256;
+
+	std::size_t strip_chunk_count_( std::size_t aVertexCount ) noexcept
+	{
+		std::size_t const segments = aVertexCount > 1 ? aVertexCount - 1 : 0;
+		return (segments + kLineStripChunkSize - 1) / kLineStripChunkSize;
+	}
+
+	struct ScreenBox_
+	{
+		float xmin, ymin;
+		float xmax, ymax;
+	};
+
+	// Conservative screen space bounds of a transformed object space box
+	ScreenBox_ transform_box_( Vec2f aMin, Vec2f aMax, Mat22f const& aRotation, Vec2f const& aTranslation ) noexcept
+	{
+		Vec2f const center = aRotation * (0.5f * (aMin + aMax)) + aTranslation;
+		Vec2f const half = 0.5f * (aMax - aMin);
+
+		float const hx = std::fabs( aRotation._00 ) * half.x + std::fabs( aRotation._01 ) * half.y;
+		float const hy = std::fabs( aRotation._10 ) * half.x + std::fabs( aRotation._11 ) * half.y;
+
+		return ScreenBox_{ center.x - hx, center.y - hy, center.x + hx, center.y + hy };
+	}
+
+	// The bounds are computed differently from the vertices themselves, so
+	// they are only trusted with a margin for rounding. clip_line() clips to
+	// the centers of the edge pixels, i.e., [0, size-1].
+	constexpr float kStripBoundsMargin = 1.f;
+
+	bool box_inside_( ScreenBox_ const& aBox, Surface const& aSurface ) noexcept
+	{
+		float const w = float(aSurface.get_width()), h = float(aSurface.get_height());
+		return aBox.xmin >= kStripBoundsMargin && aBox.xmax <= w - 1.f - kStripBoundsMargin
+			&& aBox.ymin >= kStripBoundsMargin && aBox.ymax <= h - 1.f - kStripBoundsMargin;
+	}
+	bool box_outside_( ScreenBox_ const& aBox, Surface const& aSurface ) noexcept
+	{
+		float const w = float(aSurface.get_width()), h = float(aSurface.get_height());
+		return aBox.xmax < -kStripBoundsMargin || aBox.xmin > w - 1.f + kStripBoundsMargin
+			|| aBox.ymax < -kStripBoundsMargin || aBox.ymin > h - 1.f + kStripBoundsMargin;
+	}
+
+	// LineStrip keeps the object space bounding boxes of the whole strip and
+	// of each chunk in the same allocation as its vertices, since the class
+	// cannot have additional members (shape.hpp must not change). For N
+	// vertices, mVertices holds the N vertices, then the minimum and maximum
+	// of the strip, and then the minimum and maximum of each chunk. Chunk c
+	// holds the segments starting at the vertices [first, last), so its box
+	// includes the vertex last. The boxes are computed once at construction.
+	std::size_t strip_vertex_storage_( std::size_t aCount ) noexcept
+	{
+		return aCount >= 2 ? aCount + 2 + 2*strip_chunk_count_( aCount ) : aCount;
+	}
+
+	void init_strip_bounds_( Vec2f* aVertices, std::size_t aCount ) noexcept
+	{
+		if( aCount < 2 )
+			return;
+
+		Vec2f* const strip = aVertices + aCount;
+		Vec2f* const chunk = strip + 2;
+
+		std::size_t const chunks = strip_chunk_count_( aCount );
+		for( std::size_t c = 0; c < chunks; ++c )
+		{
+			std::size_t const first = c * kLineStripChunkSize;
+			std::size_t const last = std::min( first + kLineStripChunkSize, aCount-1 );
+
+			Vec2f lo = aVertices[first], hi = aVertices[first];
+			for( std::size_t i = first+1; i <= last; ++i )
+			{
+				lo = Vec2f{ std::min( lo.x, aVertices[i].x ), std::min( lo.y, aVertices[i].y ) };
+				hi = Vec2f{ std::max( hi.x, aVertices[i].x ), std::max( hi.y, aVertices[i].y ) };
+			}
+
+			chunk[2*c+0] = lo;
+			chunk[2*c+1] = hi;
+
+			strip[0] = 0 == c ? lo : Vec2f{ std::min( strip[0].x, lo.x ), std::min( strip[0].y, lo.y ) };
+			strip[1] = 0 == c ? hi : Vec2f{ std::max( strip[1].x, hi.x ), std::max( strip[1].y, hi.y ) };
+		}
+	}
+
+	// TriangleFan keeps its per-triangle color gradients in object space
+	// (see triangle_color_gradients()) in the same allocation as its vertex
+	// colors, since the class cannot have additional members (shape.hpp
+	// must not change). For N vertices, mColors holds the N colors, then N-1
+	// x gradients, and then N-1 y gradients. Triangle i has the vertices 0,
+	// i+1 and i+2 (the last one wraps around to vertex 1). The gradients are
+	// computed once at construction and transformed to screen space when
+	// drawing.
+	std::size_t fan_color_storage_( std::size_t aCount ) noexcept
+	{
+		return aCount >= 3 ? aCount + 2*(aCount-1) : aCount;
+	}
+
+	void fan_gradients_( Vec2f const* aVertices, ColorF const* aColors, std::size_t aCount, ColorF* aColorDx, ColorF* aColorDy ) noexcept
+	{
+		for( std::size_t i = 0; i + 1 < aCount; ++i )
+		{
+			std::size_t const a = i+1;
+			std::size_t const b = i+2 < aCount ? i+2 : 1;
+
+			// Degenerate triangles get a flat color, like in setup_triangle()
+			aColorDx[i] = aColorDy[i] = ColorF{ 0.f, 0.f, 0.f };
+			triangle_color_gradients( aVertices[0], aVertices[a], aVertices[b], aColors[0], aColors[a], aColors[b], aColorDx[i], aColorDy[i] );
+		}
+	}
+
+	void init_fan_gradients_( Vec2f const* aVertices, ColorF* aColors, std::size_t aCount ) noexcept
+	{
+		if( aCount >= 3 )
+			fan_gradients_( aVertices, aColors, aCount, aColors + aCount, aColors + aCount + (aCount-1) );
+	}
+
+	// Single-colored fans are drawn with solid fills
+	bool uniform_colors_( ColorF const* aColors, std::size_t aCount ) noexcept
+	{
+		return std::all_of( aColors, aColors + aCount, [aColors] (ColorF const& aColor) {
+			return aColor.r == aColors[0].r && aColor.g == aColors[0].g && aColor.b == aColors[0].b;
+		} );
+	}
+
+	// Draws a fan with the vertices aVertices, the vertex colors aColors and
+	// the object space color gradients aColorDx and aColorDy (aCount-1 each,
+	// see fan_gradients_()). Used by TriangleFan::draw() and by
+	// draw_triangle_fan() for TiledSurface.
+	template< class tSurface >
+	void draw_fan_( tSurface& aSurface, std::size_t aCount, Vec2f const* aVertices, ColorF const* aColors, ColorF const* aColorDx, ColorF const* aColorDy, Mat22f const& aRotation, Vec2f const& aTranslation )
+	{
+		if( aCount < 3 )
+			return;
+
+		bool const uniform = uniform_colors_( aColors, aCount );
+
+		// Set up all triangles first, and then rasterize the whole fan in a
+		// single pass over its rows (see rasterize_triangle_fan()).
+		// Triangles that are degenerate or off-screen are dropped by the
+		// setup. The scratch space is reused between calls to avoid
+		// allocations.
+		thread_local std::vector<TriangleSetup> setups;
+		setups.clear();
+
+		// The object space color gradients g transform with the inverse
+		// transpose of the matrix: c(p) = c0 + g.(p-p0) with
+		// p = inv(M) (p'-t), so g' = inv(M)^T g. For a pure rotation,
+		// inv(M)^T = M.
+		double const det = double(aRotation._00) * aRotation._11 - double(aRotation._01) * aRotation._10;
+		double const invDet = 0.0 != det ? 1.0 / det : 0.0;
+
+		double const t00 = aRotation._11 * invDet, t01 = -aRotation._10 * invDet;
+		double const t10 = -aRotation._01 * invDet, t11 = aRotation._00 * invDet;
+
+		Vec2f const center = aRotation * aVertices[0] + aTranslation;
+		Vec2f const first = aRotation * aVertices[1] + aTranslation;
+
+		Vec2f previous = first;
+		for( std::size_t i = 2; i <= aCount; ++i )
+		{
+			// The last triangle closes the fan
+			Vec2f const current = i < aCount ? aRotation * aVertices[i] + aTranslation : first;
+
+			TriangleSetup setup;
+			if( setup_triangle_edges( setup, aSurface, center, previous, current ) )
+			{
+				if( !uniform )
+				{
+					ColorF const& dx = aColorDx[i-2];
+					ColorF const& dy = aColorDy[i-2];
+
+					ColorF const colorDx{
+						float(t00 * dx.r + t01 * dy.r),
+						float(t00 * dx.g + t01 * dy.g),
+						float(t00 * dx.b + t01 * dy.b)
+					};
+					ColorF const colorDy{
+						float(t10 * dx.r + t11 * dy.r),
+						float(t10 * dx.g + t11 * dy.g),
+						float(t10 * dx.b + t11 * dy.b)
+					};
+
+					setup_triangle_colors( setup, center, aColors[0], colorDx, colorDy );
+				}
+
+				setups.emplace_back( setup );
+			}
+
+			previous = current;
+		}
+
+		if( uniform )
+		{
+			// Single-colored fans only need the edge functions, and the color
+			// is encoded once.
+			ColorU8_sRGB const color = linear_to_srgb( ColorF{
+				std::clamp( aColors[0].r, 0.f, 1.f ),
+				std::clamp( aColors[0].g, 0.f, 1.f ),
+				std::clamp( aColors[0].b, 0.f, 1.f )
+			} );
+
+			rasterize_triangle_fan_solid( aSurface, setups.data(), setups.size(), pack_rgbx( color ) );
+		}
+		else
+		{
+			rasterize_triangle_fan( aSurface, setups.data(), setups.size() );
+		}
+	}
+
+	// Read-only access to the members of a TriangleFan, for drawing it to a
+	// TiledSurface with its precomputed gradients. shape.hpp cannot change,
+	// so TriangleFan has no accessors and no friends. The names of private
+	// members may, however, be used in an explicit instantiation (see
+	// [temp.spec.general]): instantiating FanMembers_ with the members
+	// defines fan_members_(), which returns pointers to them.
+	struct FanMemberPtrs_
+	{
+		std::size_t TriangleFan::* count;
+		Vec2f* TriangleFan::* vertices;
+		ColorF* TriangleFan::* colors;
+	};
+
+	FanMemberPtrs_ fan_members_() noexcept;
+
+	template< std::size_t TriangleFan::* tCount, Vec2f* TriangleFan::* tVertices, ColorF* TriangleFan::* tColors >
+	struct FanMembers_
+	{
+		friend FanMemberPtrs_ fan_members_() noexcept
+		{
+			return FanMemberPtrs_{ tCount, tVertices, tColors };
+		}
+	};
+
+	template struct FanMembers_< &TriangleFan::mCount, &TriangleFan::mVertices, &TriangleFan::mColors >;
+
+	// Draw the segments between vertices aFirst ... aLast, which must be
+	// on-screen. clip_line() would return these unchanged, so they go to
+	// setup_line() directly. A segment's first pixel is skipped if the
+	// previous segment ended on that same pixel.
+	void draw_strip_unclipped_( Surface& aSurface, Vec2f const* aVertices, std::size_t aFirst, std::size_t aLast, Mat22f const& aRotation, Vec2f const& aTranslation, std::uint32_t aRGBx )
+	{
+		bool havePixel = false;
+		int lastX = 0, lastY = 0;
+
+		Vec2f previous = aRotation * aVertices[aFirst] + aTranslation;
+		for( std::size_t i = aFirst+1; i <= aLast; ++i )
+		{
+			Vec2f const current = aRotation * aVertices[i] + aTranslation;
+
+			LineSetup setup;
+			if( setup_line( setup, aSurface, previous, current ) )
+			{
+				int const beginStep = setup.reversed ? setup.last : setup.first;
+				int const endStep = setup.reversed ? setup.first : setup.last;
+
+				int endX, endY;
+				line_step_pixel( setup, endStep, endX, endY );
+
+				if( havePixel )
+				{
+					int beginX, beginY;
+					line_step_pixel( setup, beginStep, beginX, beginY );
+
+					if( beginX == lastX && beginY == lastY )
+					{
+						if( setup.reversed )
+							--setup.last;
+						else
+							++setup.first;
+					}
+				}
+
+				rasterize_line( aSurface, setup, aRGBx );
+
+				havePixel = true;
+				lastX = endX;
+				lastY = endY;
+			}
+
+			previous = current;
+		}
+	}
+}
 
 LineStrip::LineStrip( std::size_t aCount, Vec2f const* aVerts )
 	: mCount( aCount )
@@ -15,8 +312,10 @@ LineStrip::LineStrip( std::size_t aCount, Vec2f const* aVerts )
 {
 	assert( aVerts );
 
-	mVertices = new Vec2f[mCount];
+	mVertices = new Vec2f[strip_vertex_storage_( mCount )];
 	std::memcpy( mVertices, aVerts, sizeof(Vec2f)*mCount );
+
+	init_strip_bounds_( mVertices, mCount );
 }
 
 LineStrip::~LineStrip()
@@ -35,17 +334,57 @@ LineStrip& LineStrip::operator= (LineStrip&& aOther)  noexcept
 	return *this;
 }
 
+/* LineStrip::draw() produces the same pixels as drawing each segment with
+ * draw_line_solid(), but skips clipping for parts of the strip that are
+ * entirely on-screen, and skips parts that are entirely off-screen. The
+ * checks use the transformed bounding boxes of the strip and of chunks of
+ * segments. Each pixel shared by consecutive segments is only drawn once.
+ */
 void LineStrip::draw( Surface& aSurface, ColorF const& aColor, Mat22f const& aRotation, Vec2f const& aTranslation ) const
 {
+	if( mCount < 2 )
+		return;
+
 	ColorU8_sRGB const color = linear_to_srgb( aColor );
+	std::uint32_t const rgbx = pack_rgbx( color );
+
+	// Object space bounds of the whole strip and of each chunk, stored after
+	// the vertices (see init_strip_bounds_())
+	Vec2f const* const strip = mVertices + mCount;
+	Vec2f const* const chunk = strip + 2;
 
-	Vec2f previous = aRotation * mVertices[0] + aTranslation;
+	// Whole strip on-screen?
+	ScreenBox_ const bounds = transform_box_( strip[0], strip[1], aRotation, aTranslation );
+	if( box_inside_( bounds, aSurface ) )
+		return draw_strip_unclipped_( aSurface, mVertices, 0, mCount-1, aRotation, aTranslation, rgbx );
 
-	for( std::size_t i = 1; i < mCount; ++i )
+	// Or entirely off-screen?
+	if( box_outside_( bounds, aSurface ) )
+		return;
+
+	std::size_t const chunks = strip_chunk_count_( mCount );
+	for( std::size_t c = 0; c < chunks; ++c )
 	{
-		Vec2f const current = aRotation * mVertices[i] + aTranslation;
-		draw_line_solid( aSurface, previous, current, color );
-		previous = current;
+		std::size_t const first = c * kLineStripChunkSize;
+		std::size_t const last = std::min( first + kLineStripChunkSize, mCount-1 );
+
+		ScreenBox_ const box = transform_box_( chunk[2*c+0], chunk[2*c+1], aRotation, aTranslation );
+		if( box_outside_( box, aSurface ) )
+			continue;
+
+		if( box_inside_( box, aSurface ) )
+		{
+			draw_strip_unclipped_( aSurface, mVertices, first, last, aRotation, aTranslation, rgbx );
+			continue;
+		}
+
+		Vec2f previous = aRotation * mVertices[first] + aTranslation;
+		for( std::size_t i = first+1; i <= last; ++i )
+		{
+			Vec2f const current = aRotation * mVertices[i] + aTranslation;
+			draw_line_solid( aSurface, previous, current, color );
+			previous = current;
+		}
 	}
 }
 
@@ -58,13 +397,15 @@ TriangleFan::TriangleFan( std::size_t aCount, PosAndCol const* aVerts )
 	// Note: technically unsafe if "new" fails to allocate memory
 
 	mVertices = new Vec2f[mCount];
-	mColors = new ColorF[mCount];
+	mColors = new ColorF[fan_color_storage_( mCount )];
 
 	for( std::size_t i = 0; i < mCount; ++i )
 	{
 		mVertices[i] = aVerts[i].pos;
 		mColors[i] = aVerts[i].col;
 	}
+
+	init_fan_gradients_( mVertices, mColors, mCount );
 }
 TriangleFan::TriangleFan( std::size_t aCount, Vec2f const* aVerts, ColorF const* aColors )
 	: mCount( aCount )
@@ -78,8 +419,10 @@ TriangleFan::TriangleFan( std::size_t aCount, Vec2f const* aVerts, ColorF const*
 	mVertices = new Vec2f[mCount];
 	std::memcpy( mVertices, aVerts, sizeof(Vec2f)*mCount );
 
-	mColors = new ColorF[mCount];
+	mColors = new ColorF[fan_color_storage_( mCount )];
 	std::memcpy( mColors, aColors, sizeof(ColorF)*mCount );
+
+	init_fan_gradients_( mVertices, mColors, mCount );
 }
 
 TriangleFan::~TriangleFan()
@@ -102,24 +445,35 @@ TriangleFan& TriangleFan::operator= (TriangleFan&& aOther)  noexcept
 	return *this;
 }
 
-
+/* TriangleFan::draw() rasterizes all triangles of the fan in a single pass
+ * (see rasterize_triangle_fan()). It covers the same pixels as drawing each
+ * triangle with draw_triangle_interp(). The color gradients are precomputed
+ * at construction and only transformed when drawing, so colors may differ
+ * from draw_triangle_interp() by rounding.
+ */
 void TriangleFan::draw( Surface& aSurface, Mat22f const& aRotation, Vec2f const& aTranslation ) const
 {
-	Vec2f const center = aRotation * mVertices[0] + aTranslation;
-	ColorF const cencol = mColors[0];
-
-	Vec2f previous = aRotation * mVertices[1] + aTranslation;
-	ColorF pcol = mColors[1];
-	for( std::size_t i = 2; i < mCount; ++i )
-	{
-		Vec2f const current = aRotation * mVertices[i] + aTranslation;
-		ColorF const curcol = mColors[i];
-		draw_triangle_interp( aSurface, center, previous, current, cencol, pcol, curcol );
-		previous = current;
-		pcol = curcol;
-	}
+	if( mCount < 3 )
+		return;
+
+	ColorF const* const colorDx = mColors + mCount;
+	ColorF const* const colorDy = colorDx + (mCount-1);
+	draw_fan_( aSurface, mCount, mVertices, mColors, colorDx, colorDy, aRotation, aTranslation );
+}
+
+
+void draw_triangle_fan( TiledSurface& aSurface, TriangleFan const& aFan, Mat22f const& aRotation, Vec2f const& aTranslation )
+{
+	FanMemberPtrs_ const members = fan_members_();
+
+	std::size_t const count = aFan.*members.count;
+	if( count < 3 )
+		return;
 
-	Vec2f const first = aRotation * mVertices[1] + aTranslation;
-	ColorF const fcol = mColors[1];
-	draw_triangle_interp( aSurface, center, previous, first, cencol, pcol, fcol );
+	// Same as TriangleFan::draw(); the gradients follow the colors (see
+	// fan_color_storage_())
+	ColorF const* const colors = aFan.*members.colors;
+	ColorF const* const colorDx = colors + count;
+	ColorF const* const colorDy = colorDx + (count-1);
+	draw_fan_( aSurface, count, aFan.*members.vertices, colors, colorDx, colorDy, aRotation, aTranslation );
 }
@@ -0,0 +1,200 @@
+#include "storage.hpp"
+
+#include <new>
+#include <atomic>
+#include <fstream>
+#include <string>
+
+#include <cstring>
+
+#include "surface.hpp"
+
+#if defined(__linux__)
+#	include <sys/mman.h>
+#endif
+
+namespace
+{
+	std::atomic<SurfaceStorage> gPreference_{ SurfaceStorage::hugePages };
+
+	std::atomic<SurfacePitch> gPitchPreference_{
+#		if DRAW2D_CFG_SURFACE_PITCH == DRAW2D_CFG_PITCH_PADDED
+		SurfacePitch::padded
+#		elif DRAW2D_CFG_SURFACE_PITCH == DRAW2D_CFG_PITCH_AUTO
+		SurfacePitch::automatic
+#		else
+		SurfacePitch::packed
+#		endif
+	};
+
+	PixelStorageHeader const& header_( std::uint8_t const* aPixels ) noexcept
+	{
+		return *reinterpret_cast<PixelStorageHeader const*>( aPixels - kPixelAlignment );
+	}
+
+	std::size_t choose_pitch_( std::size_t aWidth ) noexcept
+	{
+		std::size_t const rowBytes = aWidth * 4;
+
+		SurfacePitch const preference = gPitchPreference_.load( std::memory_order_relaxed );
+		if( SurfacePitch::packed == preference )
+			return rowBytes;
+
+		// 4 kB is the page size, and the L1 set stride on current x86 cores
+		if( SurfacePitch::automatic == preference && 0 != rowBytes % 4096 )
+			return rowBytes;
+
+		std::size_t const lines = (rowBytes + kPixelAlignment - 1) / kPixelAlignment;
+		return (lines | 1) * kPixelAlignment;
+	}
+
+#	if defined(__linux__)
+	constexpr std::size_t kHugePageBytes = std::size_t(2) << 20;
+
+	std::size_t round_up_( std::size_t aValue, std::size_t aMultiple ) noexcept
+	{
+		return (aValue + aMultiple - 1) / aMultiple * aMultiple;
+	}
+
+	// madvise(MADV_HUGEPAGE) succeeds even if transparent huge pages are
+	// disabled, so check the system setting, once.
+	bool thp_enabled_() noexcept
+	{
+		static bool const enabled = [] {
+			std::ifstream file( "/sys/kernel/mm/transparent_hugepage/enabled" );
+			std::string setting;
+			std::getline( file, setting );
+			return file && std::string::npos == setting.find( "[never]" );
+		}();
+		return enabled;
+	}
+
+	void* map_hugetlb_( std::size_t aBytes, std::size_t& aMapped ) noexcept
+	{
+		aMapped = round_up_( aBytes, kHugePageBytes );
+
+		void* ptr = mmap( nullptr, aMapped, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0 );
+		return MAP_FAILED != ptr ? ptr : nullptr;
+	}
+
+	void* map_thp_( std::size_t aBytes, std::size_t& aMapped ) noexcept
+	{
+		// Huge pages are only used for 2 MB aligned ranges. Map an extra huge
+		// page worth of memory, and trim the unaligned ends.
+		aMapped = round_up_( aBytes, kHugePageBytes );
+
+		std::size_t const reserved = aMapped + kHugePageBytes;
+		void* ptr = mmap( nullptr, reserved, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0 );
+		if( MAP_FAILED == ptr )
+			return nullptr;
+
+		auto* const begin = static_cast<std::uint8_t*>(ptr);
+		auto* const aligned = begin + (round_up_( reinterpret_cast<std::uintptr_t>(ptr), kHugePageBytes ) - reinterpret_cast<std::uintptr_t>(ptr));
+
+		if( aligned != begin )
+			munmap( begin, std::size_t(aligned - begin) );
+		if( std::size_t const tail = std::size_t(begin + reserved - (aligned + aMapped)); tail )
+			munmap( aligned + aMapped, tail );
+
+		if( 0 != madvise( aligned, aMapped, MADV_HUGEPAGE ) )
+		{
+			munmap( aligned, aMapped );
+			return nullptr;
+		}
+
+		return aligned;
+	}
+#	endif // ~ __linux__
+}
+
+void set_surface_storage_preference( SurfaceStorage aStorage ) noexcept
+{
+	gPreference_.store( aStorage, std::memory_order_relaxed );
+}
+
+SurfaceStorage surface_storage_preference() noexcept
+{
+	return gPreference_.load( std::memory_order_relaxed );
+}
+
+void set_surface_pitch_preference( SurfacePitch aPitch ) noexcept
+{
+	gPitchPreference_.store( aPitch, std::memory_order_relaxed );
+}
+
+SurfacePitch surface_pitch_preference() noexcept
+{
+	return gPitchPreference_.load( std::memory_order_relaxed );
+}
+
+SurfaceStorage surface_storage( Surface const& aSurface ) noexcept
+{
+	std::uint8_t const* pixels = aSurface.get_surface_ptr();
+	if( !pixels )
+		return SurfaceStorage::aligned;
+
+	return header_( pixels ).storage;
+}
+
+char const* to_string( SurfaceStorage aStorage ) noexcept
+{
+	switch( aStorage )
+	{
+		case SurfaceStorage::aligned: return "aligned";
+		case SurfaceStorage::hugePages: return "huge pages (THP)";
+		case SurfaceStorage::hugeTLB: return "huge pages (hugetlb)";
+	}
+
+	return "unknown";
+}
+
+std::uint8_t* allocate_pixels( std::size_t aWidth, std::size_t aHeight )
+{
+	std::size_t const pitch = choose_pitch_( aWidth );
+	std::size_t const pixelBytes = pitch * aHeight;
+	std::size_t const bytes = kPixelAlignment + pixelBytes;
+
+	PixelStorageHeader header{ nullptr, 0, pitch, SurfaceStorage::aligned };
+
+#	if defined(__linux__)
+	SurfaceStorage const preference = surface_storage_preference();
+	if( pixelBytes >= DRAW2D_CFG_HUGE_PAGE_BYTES )
+	{
+		if( SurfaceStorage::hugeTLB == preference )
+		{
+			if( (header.base = map_hugetlb_( bytes, header.mappedBytes )) )
+				header.storage = SurfaceStorage::hugeTLB;
+		}
+
+		if( !header.base && SurfaceStorage::aligned != preference )
+		{
+			if( (header.base = map_thp_( bytes, header.mappedBytes )) )
+				header.storage = thp_enabled_() ? SurfaceStorage::hugePages : SurfaceStorage::aligned;
+		}
+	}
+#	endif // ~ __linux__
+
+	if( !header.base )
+	{
+		header.base = ::operator new( bytes, std::align_val_t{ kPixelAlignment } );
+		header.mappedBytes = 0;
+	}
+
+	std::memcpy( header.base, &header, sizeof(header) );
+	return static_cast<std::uint8_t*>(header.base) + kPixelAlignment;
+}
+
+void free_pixels( std::uint8_t* aPixels ) noexcept
+{
+	if( !aPixels )
+		return;
+
+	PixelStorageHeader const header = header_( aPixels );
+
+#	if defined(__linux__)
+	if( header.mappedBytes )
+		return (void)munmap( header.base, header.mappedBytes );
+#	endif // ~ __linux__
+
+	::operator delete( header.base, std::align_val_t{ kPixelAlignment } );
+}
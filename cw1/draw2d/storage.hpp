@@ -0,0 +1,167 @@
+#ifndef STORAGE_HPP_6E2B9D41_3F7A_4C58_B1E0_8A4D2C7F5E93
+#define STORAGE_HPP_6E2B9D41_3F7A_4C58_B1E0_8A4D2C7F5E93
+
+// Memory for Surface pixels. Surface's constructor and destructor use
+// allocate_pixels() and free_pixels(). The storage also holds the surface's
+// row pitch, since the Surface class itself cannot change. The rest is for
+// reporting and for comparing the different kinds of storage in benchmarks.
+
+#include <utility>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "forward.hpp"
+
+/* Compile time config: huge page threshold
+ *
+ * Surfaces of at least this many bytes are backed by huge pages, if the
+ * platform supports them (see SurfaceStorage). Smaller ones only use a few
+ * regular pages, and would waste most of a 2 MB huge page.
+ */
+#if !defined(DRAW2D_CFG_HUGE_PAGE_BYTES)
+#	define DRAW2D_CFG_HUGE_PAGE_BYTES (std::size_t(4) << 20)
+#endif // ~ HUGE_PAGE_BYTES
+
+/* Compile time config: default row pitch
+ *
+ * See SurfacePitch. PACKED rows are stored back to back, which is what code
+ * outside of draw2d (e.g., the coursework's test helpers) may assume. PADDED
+ * rows avoid cache set aliasing in column-heavy work, such as steep lines.
+ * AUTO pads only the widths where packed rows alias, and keeps the common
+ * widths (e.g., 1280 and 1920) packed.
+ */
+#define DRAW2D_CFG_PITCH_PACKED 1
+#define DRAW2D_CFG_PITCH_PADDED 2
+#define DRAW2D_CFG_PITCH_AUTO 3
+
+#if !defined(DRAW2D_CFG_SURFACE_PITCH)
+#	define DRAW2D_CFG_SURFACE_PITCH DRAW2D_CFG_PITCH_AUTO
+#endif // ~ SURFACE_PITCH
+
+/** Kinds of surface storage
+ *
+ * Pixel data is always aligned to kPixelAlignment bytes. Large surfaces are
+ * additionally backed by huge pages, which reduces the number of TLB misses
+ * in full-surface passes:
+ *  - hugeTLB: explicit huge pages (Linux MAP_HUGETLB). These must have been
+ *    reserved by the administrator, so this often fails.
+ *  - hugePages: transparent huge pages (Linux madvise(MADV_HUGEPAGE)). The
+ *    kernel may still use regular pages, e.g., if memory is fragmented.
+ *  - aligned: regular pages.
+ *
+ * If a kind is not available, allocation falls back to the next one in the
+ * list above.
+ */
+enum class SurfaceStorage
+{
+	aligned,
+	hugePages,
+	hugeTLB
+};
+
+constexpr std::size_t kPixelAlignment = 64;
+
+/** Row pitch
+ *
+ * The pitch is the distance between the starts of two consecutive rows, in
+ * bytes. Rows are either
+ *  - packed: the pitch is the width times four bytes, or
+ *  - padded: the pitch is the smallest odd number of cache lines (64 bytes)
+ *    that holds a row.
+ *
+ * With packed rows, widths such as 4096 and 8192 map vertically adjacent
+ * pixels to the same few cache sets (the pitch is a multiple of 4 kB), so a
+ * walk down a column evicts its own cache lines. An odd number of cache
+ * lines cycles through all sets instead. Padded rows also start on a cache
+ * line boundary.
+ *
+ * automatic picks padded rows if the packed pitch is a multiple of 4 kB,
+ * and packed rows otherwise.
+ *
+ * The padding pixels are part of the surface's memory, but are not part of
+ * the image; Surface::clear() and Surface::fill() may overwrite them.
+ */
+enum class SurfacePitch
+{
+	packed,
+	padded,
+	automatic
+};
+
+/** Select the preferred kind of storage
+ *
+ * Applies to surfaces that are allocated afterwards. The default is
+ * SurfaceStorage::hugePages. Mainly intended for benchmarks.
+ */
+void set_surface_storage_preference( SurfaceStorage ) noexcept;
+SurfaceStorage surface_storage_preference() noexcept;
+
+/** Select the row pitch
+ *
+ * Applies to surfaces that are allocated afterwards. The default is set by
+ * DRAW2D_CFG_SURFACE_PITCH.
+ */
+void set_surface_pitch_preference( SurfacePitch ) noexcept;
+SurfacePitch surface_pitch_preference() noexcept;
+
+/** Query storage
+ *
+ * Returns the kind of storage that is actually used by the surface, after
+ * any fallbacks.
+ */
+SurfaceStorage surface_storage( Surface const& ) noexcept;
+
+char const* to_string( SurfaceStorage ) noexcept;
+
+/** Query the row pitch
+ *
+ * Returns the pitch in bytes. Row y of the surface starts at byte
+ * y * pitch, and get_linear_index() returns y * (pitch/4) + x.
+ * pixel_pitch() takes the pointer returned by allocate_pixels().
+ */
+std::size_t surface_pitch( Surface const& ) noexcept;
+std::size_t pixel_pitch( std::uint8_t const* ) noexcept;
+
+/** Allocate and free pixel data
+ *
+ * allocate_pixels() returns the memory for aHeight rows of aWidth pixels,
+ * aligned to kPixelAlignment, with the preferred row pitch and in the
+ * preferred kind of storage. It throws std::bad_alloc if no memory is
+ * available. The pointer must be released with free_pixels().
+ */
+std::uint8_t* allocate_pixels( std::size_t aWidth, std::size_t aHeight );
+void free_pixels( std::uint8_t* ) noexcept;
+
+// Information stored in front of the pixel data. Padding the header to
+// kPixelAlignment keeps the pixels aligned.
+struct PixelStorageHeader
+{
+	void* base;
+	std::size_t mappedBytes; // zero if allocated with operator new
+	std::size_t pitch;
+	SurfaceStorage storage;
+};
+
+static_assert( sizeof(PixelStorageHeader) <= kPixelAlignment );
+
+// storage.inl needs the complete Surface class. If this header is included
+// first, surface.hpp includes it again via surface.inl, which then only needs
+// the declarations above.
+#include "surface.hpp"
+
+/** Row access
+ *
+ * Returns a pointer to the first pixel of row aY. This is intended for the
+ * draw2d internals that write whole spans of pixels at a time (e.g., the
+ * SIMD kernels). Other code should use Surface::set_pixel_srgb(). The
+ * Surface class only exposes its pixels via get_surface_ptr(); the rows
+ * are surface_pitch() bytes apart.
+ */
+std::uint8_t* surface_row_ptr( Surface&, Surface::Index aY ) noexcept;
+std::uint8_t const* surface_row_ptr( Surface const&, Surface::Index aY ) noexcept;
+
+#include "storage.inl"
+
+#endif // STORAGE_HPP_6E2B9D41_3F7A_4C58_B1E0_8A4D2C7F5E93
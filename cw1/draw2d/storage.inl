@@ -0,0 +1,30 @@
+inline
+std::size_t pixel_pitch( std::uint8_t const* aPixels ) noexcept
+{
+	assert( aPixels );
+
+	PixelStorageHeader const* header = reinterpret_cast<PixelStorageHeader const*>(aPixels - kPixelAlignment);
+	return header->pitch;
+}
+
+inline
+std::size_t surface_pitch( Surface const& aSurface ) noexcept
+{
+	return pixel_pitch( aSurface.get_surface_ptr() );
+}
+
+inline
+std::uint8_t const* surface_row_ptr( Surface const& aSurface, Surface::Index aY ) noexcept
+{
+	assert( aY < aSurface.get_height() );
+
+	std::uint8_t const* pixels = aSurface.get_surface_ptr();
+	return pixels + std::size_t(aY) * pixel_pitch( pixels );
+}
+
+inline
+std::uint8_t* surface_row_ptr( Surface& aSurface, Surface::Index aY ) noexcept
+{
+	// The pixels belong to the (non-const) surface
+	return const_cast<std::uint8_t*>(surface_row_ptr( std::as_const( aSurface ), aY ));
+}
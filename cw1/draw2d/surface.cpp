@@ -1,20 +1,22 @@
 #include "surface.hpp"
 #include "color.hpp"
+#include "fill.hpp"
+#include "storage.hpp"
 
 #include <utility>
 
-#include <cstring>  // This defines std::memset()...
-
 Surface::Surface( Index aWidth, Index aHeight )
 	: mSurface( nullptr )
 	, mWidth( aWidth )
 	, mHeight( aHeight )
 {
-	mSurface = new std::uint8_t[ mWidth * mHeight * 4 ];
+	// Aligned, and backed by huge pages if large. Rows may be padded (see
+	// storage.hpp).
+	mSurface = allocate_pixels( mWidth, mHeight );
 }
 Surface::~Surface()
 {
-	delete [] mSurface;
+	free_pixels( mSurface );
 }
 
 Surface::Surface( Surface&& aOther ) noexcept
@@ -33,21 +35,17 @@ Surface& Surface::operator=( Surface&& aOther ) noexcept
 
 void Surface::clear() noexcept
 {
-	std::memset( mSurface, 0, sizeof(std::uint8_t)*mWidth*mHeight*4 );
+	// Same as a memset() to zero, but large surfaces are streamed instead of
+	// being pulled through the cache (see fill_pixels()).
+	// The padding at the end of each row (if any) is cleared as well, so
+	// that the whole surface is a single block.
+	fill_pixels( mSurface, pixel_pitch( mSurface )/4 * mHeight, 0 );
 }
 
 void Surface::fill( ColorU8_sRGB aColor ) noexcept
 {
-	// This can be optimized quite a bit. 8 bit loads and stores are generally
-	// not the most efficient.
-	auto const limit = mWidth * mHeight * 4;
-	for( std::size_t i = 0; i < limit; i += 4 )
-	{
-		mSurface[i+0] = aColor.r;
-		mSurface[i+1] = aColor.g;
-		mSurface[i+2] = aColor.b;
-		mSurface[i+3] = 0;
-	}
+	// One 32-bit pattern per pixel instead of four byte stores
+	fill_pixels( mSurface, pixel_pitch( mSurface )/4 * mHeight, pack_rgbx( aColor ) );
 }
 
 std::uint8_t const* Surface::get_surface_ptr() const noexcept
@@ -11,6 +11,8 @@
  * set_pixel_srgb() zero overhead abstractions.
  *
  */
+#include "storage.hpp" // for pixel_pitch()
+
 inline
 void Surface::set_pixel_srgb( Index aX, Index aY, ColorU8_sRGB const& aColor )
 {
@@ -43,5 +45,6 @@ Rect2F Surface::clip_area() const noexcept
 inline
 auto Surface::get_linear_index( Index aX, Index aY ) const noexcept -> Index
 {
-	return aY * mWidth + aX;
+	// Rows may be padded (see SurfacePitch)
+	return aY * Index(pixel_pitch( mSurface ) / 4) + aX;
 }
@@ -0,0 +1,185 @@
+#include "tiled.hpp"
+
+#include <utility>
+#include <algorithm>
+
+#include <cstring>
+
+#include "cpu.hpp"
+#include "fill.hpp"
+#include "storage.hpp"
+#include "surface.hpp"
+
+namespace
+{
+	// Copy a strip of aTiles tiles starting at aStrip to aRows rows of the
+	// linear layout, which start at aDst and are aPitch bytes apart. Only
+	// the first aLastCount pixels of the last tile are part of the surface.
+	void detile_strip_scalar_( std::uint8_t* aDst, std::size_t aPitch, std::uint8_t const* aStrip, std::size_t aTiles, std::size_t aRows, std::size_t aLastCount ) noexcept
+	{
+		for( std::size_t i = 0; i < aTiles; ++i )
+		{
+			std::size_t const bytes = i + 1 < aTiles ? TiledSurface::kTileRowBytes : 4*aLastCount;
+			for( std::size_t r = 0; r < aRows; ++r )
+				std::memcpy( aDst + r*aPitch + i*TiledSurface::kTileRowBytes, aStrip + i*TiledSurface::kTileBytes + r*TiledSurface::kTileRowBytes, bytes );
+		}
+	}
+
+#	if DRAW2D_CFG_ENABLE_AVX2
+	template< bool tStream >
+	DRAW2D_TARGET_AVX2
+	void detile_strip_avx2_( std::uint8_t* aDst, std::size_t aPitch, std::uint8_t const* aStrip, std::size_t aTiles, std::size_t aRows, std::size_t aLastCount ) noexcept
+	{
+		// Tiles are read in order, one 32-byte aligned load per tile row
+		// (tiles are 256 bytes, and strips start on kPixelAlignment). The
+		// destination rows are only aligned if streaming.
+		std::size_t i = 0;
+		for( ; i + 2 < aTiles; i += 2 )
+		{
+			std::uint8_t const* const tile = aStrip + i*TiledSurface::kTileBytes;
+			std::uint8_t* const dst = aDst + i*TiledSurface::kTileRowBytes;
+
+			for( std::size_t r = 0; r < aRows; ++r )
+			{
+				__m256i const a = _mm256_load_si256( reinterpret_cast<__m256i const*>(tile + r*TiledSurface::kTileRowBytes) );
+				__m256i const b = _mm256_load_si256( reinterpret_cast<__m256i const*>(tile + TiledSurface::kTileBytes + r*TiledSurface::kTileRowBytes) );
+
+				auto* const out = reinterpret_cast<__m256i*>(dst + r*aPitch);
+				if constexpr( tStream )
+				{
+					_mm256_stream_si256( out, a );
+					_mm256_stream_si256( out+1, b );
+				}
+				else
+				{
+					_mm256_storeu_si256( out, a );
+					_mm256_storeu_si256( out+1, b );
+				}
+			}
+		}
+		for( ; i + 1 < aTiles; ++i )
+		{
+			for( std::size_t r = 0; r < aRows; ++r )
+			{
+				__m256i const row = _mm256_load_si256( reinterpret_cast<__m256i const*>(aStrip + i*TiledSurface::kTileBytes + r*TiledSurface::kTileRowBytes) );
+				_mm256_storeu_si256( reinterpret_cast<__m256i*>(aDst + r*aPitch + i*TiledSurface::kTileRowBytes), row );
+			}
+		}
+
+		__m256i const lane = _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 );
+		__m256i const mask = _mm256_cmpgt_epi32( _mm256_set1_epi32( int(aLastCount) ), lane );
+
+		std::size_t const last = aTiles - 1;
+		for( std::size_t r = 0; r < aRows; ++r )
+		{
+			__m256i const row = _mm256_load_si256( reinterpret_cast<__m256i const*>(aStrip + last*TiledSurface::kTileBytes + r*TiledSurface::kTileRowBytes) );
+			_mm256_maskstore_epi32( reinterpret_cast<int*>(aDst + r*aPitch + last*TiledSurface::kTileRowBytes), mask, row );
+		}
+	}
+#	endif // ~ ENABLE_AVX2
+}
+
+TiledSurface::TiledSurface( Index aWidth, Index aHeight )
+	: mSurface( nullptr )
+	, mWidth( aWidth )
+	, mHeight( aHeight )
+	, mTilesX( (aWidth + kTileSize - 1) / kTileSize )
+	, mTilesY( (aHeight + kTileSize - 1) / kTileSize )
+{
+	// One "row" of the storage per strip of tiles
+	mSurface = allocate_pixels( std::size_t(mTilesX) * kTileSize*kTileSize, mTilesY );
+	mStripPixels = pixel_pitch( mSurface ) / 4;
+}
+TiledSurface::~TiledSurface()
+{
+	free_pixels( mSurface );
+}
+
+TiledSurface::TiledSurface( TiledSurface&& aOther ) noexcept
+	: mSurface( std::exchange( aOther.mSurface, nullptr ) )
+	, mWidth( std::exchange( aOther.mWidth, 0 ) )
+	, mHeight( std::exchange( aOther.mHeight, 0 ) )
+	, mTilesX( std::exchange( aOther.mTilesX, 0 ) )
+	, mTilesY( std::exchange( aOther.mTilesY, 0 ) )
+	, mStripPixels( std::exchange( aOther.mStripPixels, 0 ) )
+{}
+TiledSurface& TiledSurface::operator=( TiledSurface&& aOther ) noexcept
+{
+	std::swap( mSurface, aOther.mSurface );
+	std::swap( mWidth, aOther.mWidth );
+	std::swap( mHeight, aOther.mHeight );
+	std::swap( mTilesX, aOther.mTilesX );
+	std::swap( mTilesY, aOther.mTilesY );
+	std::swap( mStripPixels, aOther.mStripPixels );
+	return *this;
+}
+
+void TiledSurface::clear() noexcept
+{
+	fill_pixels( mSurface, mStripPixels * mTilesY, 0 );
+}
+
+void TiledSurface::fill( ColorU8_sRGB aColor ) noexcept
+{
+	fill_pixels( mSurface, mStripPixels * mTilesY, pack_rgbx( aColor ) );
+}
+
+std::uint8_t const* TiledSurface::get_surface_ptr() const noexcept
+{
+	return mSurface;
+}
+
+
+void detile( Surface& aSurface, TiledSurface const& aTiled )
+{
+	assert( aSurface.get_width() == aTiled.get_width() );
+	assert( aSurface.get_height() == aTiled.get_height() );
+
+	if( 0 == aTiled.get_width() || 0 == aTiled.get_height() )
+		return;
+
+	// One strip of tiles at a time. Tiles are read sequentially; each is
+	// written to kTileSize rows, and consecutive tiles continue the rows.
+	std::size_t const tiles = aTiled.get_tiles_x();
+	std::size_t const lastCount = aTiled.get_width() - (tiles-1) * TiledSurface::kTileSize;
+	std::size_t const pitch = surface_pitch( aSurface );
+
+	auto const for_each_strip = [&] (auto&& aStripFn) {
+		for( Surface::Index y = 0; y < aTiled.get_height(); y += TiledSurface::kTileSize )
+		{
+			std::size_t const rows = std::min<std::size_t>( TiledSurface::kTileSize, aTiled.get_height() - y );
+			aStripFn( surface_row_ptr( aSurface, y ), aTiled.get_tile_row_ptr( 0, y ), rows );
+		}
+	};
+
+#	if DRAW2D_CFG_ENABLE_AVX2
+	if( cpu_has_avx2() )
+	{
+		bool const stream = pitch * aSurface.get_height() >= DRAW2D_CFG_FILL_STREAM_BYTES
+			&& 0 == pitch % 32
+		;
+
+		if( stream )
+		{
+			for_each_strip( [&] (std::uint8_t* aDst, std::uint8_t const* aStrip, std::size_t aRows) {
+				detile_strip_avx2_<true>( aDst, pitch, aStrip, tiles, aRows, lastCount );
+			} );
+
+			// See fill_pixels()
+			_mm_sfence();
+		}
+		else
+		{
+			for_each_strip( [&] (std::uint8_t* aDst, std::uint8_t const* aStrip, std::size_t aRows) {
+				detile_strip_avx2_<false>( aDst, pitch, aStrip, tiles, aRows, lastCount );
+			} );
+		}
+
+		return;
+	}
+#	endif // ~ ENABLE_AVX2
+
+	for_each_strip( [&] (std::uint8_t* aDst, std::uint8_t const* aStrip, std::size_t aRows) {
+		detile_strip_scalar_( aDst, pitch, aStrip, tiles, aRows, lastCount );
+	} );
+}
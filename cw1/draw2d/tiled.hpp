@@ -0,0 +1,115 @@
+#ifndef TILED_HPP_9C3A5E17_4B2D_4F86_A0C1_7D5E8B2F6A34
+#define TILED_HPP_9C3A5E17_4B2D_4F86_A0C1_7D5E8B2F6A34
+
+// A surface that stores its pixels in square tiles rather than in rows. The
+// tiled layout is only used for drawing; detile() converts it to a regular
+// Surface for display (Context::draw()) or capture.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "rect.hpp"
+#include "color.hpp"
+#include "forward.hpp"
+
+#include "../vmlib/vec2.hpp"
+#include "../vmlib/mat22.hpp"
+
+/** TiledSurface - a surface with pixels stored in 8x8 tiles
+ *
+ * Pixels have the same 32-bit RGBx format as in Surface. The surface is
+ * divided into tiles of kTileSize x kTileSize pixels. Each tile is stored
+ * contiguously, with its rows back to back, so a tile is 256 bytes (four
+ * cache lines) and one of its rows is 32 bytes (a single AVX2 register).
+ * Tiles are stored in row-major order, and a row of tiles ("strip") is laid
+ * out like a row of a Surface that is kTileSize*kTileSize pixels per tile
+ * wide (see storage.hpp; the strip pitch follows the same SurfacePitch
+ * preference).
+ *
+ * Drawing something small touches far fewer cache lines and pages than in
+ * the linear layout: an 8x8 block of pixels is four cache lines instead of
+ * eight (one per row), and a 30 pixel asteroid spans a few tile strips
+ * instead of 60 rows that are a full surface row apart.
+ *
+ * The width and height do not need to be multiples of the tile size. The
+ * pixels of the partial tiles at the right and top edges that are outside of
+ * the surface are never drawn to, and are ignored by detile().
+ *
+ * Like Surface, TiledSurface is move-only.
+ */
+class TiledSurface final
+{
+	public:
+		using Index = std::uint32_t;
+
+		static constexpr Index kTileSize = 8;
+		static constexpr std::size_t kTileRowBytes = kTileSize*4;
+		static constexpr std::size_t kTileBytes = kTileSize*kTileRowBytes;
+
+	public:
+		TiledSurface( Index aWidth, Index aHeight );
+		~TiledSurface();
+
+		TiledSurface( TiledSurface const& ) = delete;
+		TiledSurface& operator= (TiledSurface const&) = delete;
+
+		TiledSurface( TiledSurface&& ) noexcept;
+		TiledSurface& operator= (TiledSurface&&) noexcept;
+
+	public:
+		// Clear to black, or fill with a single color. Like Surface, this
+		// includes the parts of the edge tiles outside of the surface.
+		void clear() noexcept;
+		void fill( ColorU8_sRGB ) noexcept;
+
+		void set_pixel_srgb( Index aX, Index aY, ColorU8_sRGB const& );
+
+		// Pointer to the pixel at the start of the tile row that contains
+		// (aX,aY), i.e., to pixel (aX - aX % kTileSize, aY). The following
+		// kTileSize pixels are (consecutive) pixels of row aY.
+		std::uint8_t* get_tile_row_ptr( Index aX, Index aY ) noexcept;
+		std::uint8_t const* get_tile_row_ptr( Index aX, Index aY ) const noexcept;
+
+		std::uint8_t const* get_surface_ptr() const noexcept;
+
+		Index get_width() const noexcept;
+		Index get_height() const noexcept;
+
+		Index get_tiles_x() const noexcept;
+		Index get_tiles_y() const noexcept;
+
+		Rect2F clip_area() const noexcept;
+
+		// Compute the index of pixel (aX,aY) in the tiled layout
+		std::size_t get_linear_index( Index aX, Index aY ) const noexcept;
+
+	private:
+		std::uint8_t* mSurface;
+		Index mWidth, mHeight;
+		Index mTilesX, mTilesY;
+
+		// Distance between strips, in pixels. Kept here rather than read
+		// from the storage header for each pixel, since the pixel stores may
+		// alias the header.
+		std::size_t mStripPixels;
+};
+
+/** Convert a tiled surface to the linear layout
+ *
+ * Copies the pixels of aTiled to aSurface, which must have the same size.
+ * Each tile row is a single 32-byte load and store with AVX2. Rows of large
+ * surfaces are written with streaming stores (see fill_pixels()), since the
+ * result is typically only read once more, by the upload to the GPU.
+ */
+void detile( Surface&, TiledSurface const& );
+
+/** Draw a triangle fan to a tiled surface
+ *
+ * Produces the same pixels as TriangleFan::draw(), and likewise uses the
+ * color gradients that the fan computed at construction. Spans are split at
+ * tile boundaries, and each part is shaded as a single tile row.
+ */
+void draw_triangle_fan( TiledSurface&, TriangleFan const&, Mat22f const&, Vec2f const& );
+
+#include "tiled.inl"
+#endif // TILED_HPP_9C3A5E17_4B2D_4F86_A0C1_7D5E8B2F6A34
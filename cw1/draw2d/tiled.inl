@@ -0,0 +1,63 @@
+#include <cassert>
+
+inline
+void TiledSurface::set_pixel_srgb( Index aX, Index aY, ColorU8_sRGB const& aColor )
+{
+	assert( aX < mWidth && aY < mHeight );
+	std::size_t const idx = get_linear_index( aX, aY ) * 4;
+
+	mSurface[idx + 0] = aColor.r;
+	mSurface[idx + 1] = aColor.g;
+	mSurface[idx + 2] = aColor.b;
+	mSurface[idx + 3] = 0;
+}
+
+inline
+std::uint8_t* TiledSurface::get_tile_row_ptr( Index aX, Index aY ) noexcept
+{
+	return mSurface + 4*get_linear_index( aX - aX % kTileSize, aY );
+}
+inline
+std::uint8_t const* TiledSurface::get_tile_row_ptr( Index aX, Index aY ) const noexcept
+{
+	return mSurface + 4*get_linear_index( aX - aX % kTileSize, aY );
+}
+
+inline
+auto TiledSurface::get_width() const noexcept -> Index
+{
+	return mWidth;
+}
+inline
+auto TiledSurface::get_height() const noexcept -> Index
+{
+	return mHeight;
+}
+
+inline
+auto TiledSurface::get_tiles_x() const noexcept -> Index
+{
+	return mTilesX;
+}
+inline
+auto TiledSurface::get_tiles_y() const noexcept -> Index
+{
+	return mTilesY;
+}
+
+inline
+Rect2F TiledSurface::clip_area() const noexcept
+{
+	return Rect2F{ 0.f, 0.f, float(mWidth), float(mHeight) };
+}
+
+inline
+std::size_t TiledSurface::get_linear_index( Index aX, Index aY ) const noexcept
+{
+	assert( aX < mTilesX*kTileSize && aY < mTilesY*kTileSize );
+
+	// Strip, then tile within the strip, then row and pixel within the tile
+	std::size_t const strip = std::size_t(aY / kTileSize) * mStripPixels;
+	std::size_t const tile = std::size_t(aX / kTileSize) * (kTileSize*kTileSize);
+	return strip + tile + (aY % kTileSize) * kTileSize + aX % kTileSize;
+}
@@ -0,0 +1,665 @@
+#include "triangle.hpp"
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include <cmath>
+#include <cstring>
+
+#include "draw.hpp"
+#include "fill.hpp"
+#include "storage.hpp"
+#include "surface.hpp"
+#include "tiled.hpp"
+
+namespace
+{
+	float plane_gradient_( double aD1, double aD2, double aU1, double aU2, double aDet ) noexcept
+	{
+		return float((aD1 * aU2 - aD2 * aU1) / aDet);
+	}
+
+	// Reject vertices that would overflow the fixed point edge functions. The
+	// comparison is written such that NaNs are rejected as well.
+	bool in_range_( Vec2f aP0, Vec2f aP1, Vec2f aP2 ) noexcept
+	{
+		for( Vec2f const& p : { aP0, aP1, aP2 } )
+		{
+			if( !(std::abs( p.x ) <= kTriangleMaxCoord && std::abs( p.y ) <= kTriangleMaxCoord) )
+				return false;
+		}
+
+		return true;
+	}
+
+	// The part of setup_triangle_edges() after clamping the bounding box
+	bool setup_edges_( TriangleSetup& aSetup, bound_box_for_triangle const& aBox, Vec2f aP0, Vec2f aP1, Vec2f aP2 ) noexcept
+	{
+		if( aBox.xmax < aBox.xmin || aBox.ymax < aBox.ymin )
+			return false;
+
+		aSetup.xmin = int(aBox.xmin);
+		aSetup.xmax = int(aBox.xmax);
+		aSetup.ymin = int(aBox.ymin);
+		aSetup.ymax = int(aBox.ymax);
+
+		// Snap vertices and orient the triangle counter-clockwise
+		std::int64_t const x[3] = { snap_triangle_coord( aP0.x ), snap_triangle_coord( aP1.x ), snap_triangle_coord( aP2.x ) };
+		std::int64_t const y[3] = { snap_triangle_coord( aP0.y ), snap_triangle_coord( aP1.y ), snap_triangle_coord( aP2.y ) };
+
+		return setup_convex_edges<3>( x, y, aSetup.xmin, aSetup.ymin, aSetup.edge, aSetup.edgeDx, aSetup.edgeDy );
+	}
+
+	enum class BlockCoverage_
+	{
+		none,
+		partial,
+		full
+	};
+
+	// Edge functions at the center of pixel (aX,aY)
+	void edges_at_( TriangleSetup const& aSetup, int aX, int aY, std::int64_t aEdges[3] ) noexcept
+	{
+		for( int i = 0; i < 3; ++i )
+			aEdges[i] = aSetup.edge[i] + aSetup.edgeDx[i] * (aX - aSetup.xmin) + aSetup.edgeDy[i] * (aY - aSetup.ymin);
+	}
+
+	// Classify the pixels [aX0,aX1] x [aY0,aY1]. The edge functions are
+	// affine, so their minimum and maximum over the block are found at the
+	// corners. Which corners is determined by the signs of the increments.
+	BlockCoverage_ classify_block_( TriangleSetup const& aSetup, int aX0, int aY0, int aX1, int aY1 ) noexcept
+	{
+		std::int64_t corner[3];
+		edges_at_( aSetup, aX0, aY0, corner );
+
+		bool full = true;
+		for( int i = 0; i < 3; ++i )
+		{
+			std::int64_t const sx = aSetup.edgeDx[i] * (aX1 - aX0);
+			std::int64_t const sy = aSetup.edgeDy[i] * (aY1 - aY0);
+
+			std::int64_t const lo = corner[i] + std::min( sx, std::int64_t(0) ) + std::min( sy, std::int64_t(0) );
+			std::int64_t const hi = corner[i] + std::max( sx, std::int64_t(0) ) + std::max( sy, std::int64_t(0) );
+
+			if( hi < 0 )
+				return BlockCoverage_::none;
+			if( lo < 0 )
+				full = false;
+		}
+
+		return full ? BlockCoverage_::full : BlockCoverage_::partial;
+	}
+
+	struct ActiveTriangle_
+	{
+		std::size_t index;
+		std::int64_t row[3]; // edge functions at the start of the current row
+	};
+
+	// Walks the rows of a set of triangles in a single pass. aSpanFn is called
+	// with each covered span; within a row, triangles are visited in order of
+	// their index. Triangles enter the active list at their first row and
+	// are removed after their last one.
+	template< typename tSpanFn >
+	void walk_triangle_rows_( TriangleSetup const* aSetups, std::size_t aCount, tSpanFn&& aSpanFn )
+	{
+		if( 0 == aCount )
+			return;
+
+		// Scratch space is reused between calls to avoid allocations
+		thread_local std::vector<std::size_t> order;
+		thread_local std::vector<ActiveTriangle_> active;
+
+		order.resize( aCount );
+		std::iota( order.begin(), order.end(), std::size_t(0) );
+		std::stable_sort( order.begin(), order.end(), [aSetups] (std::size_t aA, std::size_t aB) {
+			return aSetups[aA].ymin < aSetups[aB].ymin;
+		} );
+
+		int ymax = aSetups[0].ymax;
+		for( std::size_t i = 1; i < aCount; ++i )
+			ymax = std::max( ymax, aSetups[i].ymax );
+
+		active.clear();
+
+		std::size_t next = 0;
+		for( int y = aSetups[order[0]].ymin; y <= ymax; ++y )
+		{
+			std::erase_if( active, [aSetups,y] (ActiveTriangle_ const& aActive) {
+				return aSetups[aActive.index].ymax < y;
+			} );
+
+			// Skip rows that no triangle covers
+			if( active.empty() )
+			{
+				if( next == aCount )
+					break;
+
+				y = std::max( y, aSetups[order[next]].ymin );
+			}
+
+			for( ; next < aCount && aSetups[order[next]].ymin <= y; ++next )
+			{
+				TriangleSetup const& setup = aSetups[order[next]];
+
+				ActiveTriangle_ entry;
+				entry.index = order[next];
+				edges_at_( setup, setup.xmin, y, entry.row );
+
+				auto const pos = std::lower_bound( active.begin(), active.end(), entry.index, [] (ActiveTriangle_ const& aActive, std::size_t aIndex) {
+					return aActive.index < aIndex;
+				} );
+				active.insert( pos, entry );
+			}
+
+			for( auto& entry : active )
+			{
+				TriangleSetup const& setup = aSetups[entry.index];
+
+				int begin, end;
+				if( triangle_row_span( setup, entry.row, begin, end ) )
+					aSpanFn( setup, y, begin, end );
+
+				entry.row[0] += setup.edgeDy[0];
+				entry.row[1] += setup.edgeDy[1];
+				entry.row[2] += setup.edgeDy[2];
+			}
+		}
+	}
+
+	// Store the color of pixel aX in the row that starts at aRowPtr. The
+	// scalar paths look up the row once and then use this, rather than
+	// set_pixel_srgb(): its byte stores may alias the pitch in the storage
+	// header, which then has to be reloaded for every pixel.
+	void store_pixel_( std::uint8_t* aRowPtr, int aX, ColorU8_sRGB const& aColor ) noexcept
+	{
+		std::uint32_t const rgbx = pack_rgbx( aColor );
+		std::memcpy( aRowPtr + 4*std::size_t(aX), &rgbx, sizeof(rgbx) );
+	}
+
+#	if DRAW2D_CFG_ENABLE_AVX2
+	DRAW2D_TARGET_AVX2
+	__m256 color_channel8_avx2_( float aGradient, float aRow, __m256 aDx ) noexcept
+	{
+		// Same operations as triangle_color_at(): fma, then clamp to [0,1]
+		__m256 const value = _mm256_fmadd_ps( _mm256_set1_ps( aGradient ), aDx, _mm256_set1_ps( aRow ) );
+		return _mm256_min_ps( _mm256_max_ps( value, _mm256_setzero_ps() ), _mm256_set1_ps( 1.f ) );
+	}
+
+	// Shade the 8 pixels starting at aX, and store them at aPixels. Only the
+	// lanes enabled in aMask are written.
+	DRAW2D_TARGET_AVX2
+	void shade8_to_avx2_( std::uint8_t* aPixels, int aX, __m256i aMask, TriangleSetup const& aSetup, ColorF const& aRow ) noexcept
+	{
+		__m256i const lane = _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 );
+		__m256 const dx = _mm256_cvtepi32_ps( _mm256_add_epi32( _mm256_set1_epi32( aX - aSetup.xmin ), lane ) );
+
+		__m256i const rgbx = linear_to_srgb_avx2(
+			color_channel8_avx2_( aSetup.colorDx.r, aRow.r, dx ),
+			color_channel8_avx2_( aSetup.colorDx.g, aRow.g, dx ),
+			color_channel8_avx2_( aSetup.colorDx.b, aRow.b, dx )
+		);
+
+		_mm256_maskstore_epi32( reinterpret_cast<int*>(aPixels), aMask, rgbx );
+	}
+
+	// As above, for the pixels starting at aX in the row at aRowPtr
+	DRAW2D_TARGET_AVX2
+	void shade8_avx2_( std::uint8_t* aRowPtr, int aX, __m256i aMask, TriangleSetup const& aSetup, ColorF const& aRow ) noexcept
+	{
+		shade8_to_avx2_( aRowPtr + 4*std::size_t(aX), aX, aMask, aSetup, aRow );
+	}
+
+	// Returns a mask with the lanes [0, aCount) enabled
+	DRAW2D_TARGET_AVX2
+	__m256i first_lanes_avx2_( int aCount ) noexcept
+	{
+		__m256i const lane = _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 );
+		return _mm256_cmpgt_epi32( _mm256_set1_epi32( aCount ), lane );
+	}
+
+	// Returns a mask with the lanes whose bit is set in aBits enabled
+	DRAW2D_TARGET_AVX2
+	__m256i lanes_from_bits_avx2_( int aBits ) noexcept
+	{
+		__m256i const bit = _mm256_setr_epi32( 1, 2, 4, 8, 16, 32, 64, 128 );
+		return _mm256_cmpeq_epi32( _mm256_and_si256( _mm256_set1_epi32( aBits ), bit ), bit );
+	}
+
+	// Returns a bit mask with the pixels [0, aCount) covered by the triangle.
+	// aEdges are the edge functions at the first pixel. The edge functions
+	// are 64-bit, so this takes two registers per edge. A pixel is covered if
+	// the sign bit of the OR of its three edge functions is clear.
+	DRAW2D_TARGET_AVX2
+	int coverage8_avx2_( TriangleSetup const& aSetup, std::int64_t const aEdges[3], int aCount ) noexcept
+	{
+		__m256i lo = _mm256_setzero_si256(), hi = _mm256_setzero_si256();
+		for( int i = 0; i < 3; ++i )
+		{
+			std::int64_t const e = aEdges[i];
+			std::int64_t const dx = aSetup.edgeDx[i];
+			__m256i const first = _mm256_setr_epi64x( e, e + dx, e + 2*dx, e + 3*dx );
+			lo = _mm256_or_si256( lo, first );
+			hi = _mm256_or_si256( hi, _mm256_add_epi64( first, _mm256_set1_epi64x( 4*dx ) ) );
+		}
+
+		int const outside = _mm256_movemask_pd( _mm256_castsi256_pd( lo ) )
+			| _mm256_movemask_pd( _mm256_castsi256_pd( hi ) ) << 4;
+		int const valid = (1 << std::min( 8, aCount )) - 1;
+
+		return ~outside & valid;
+	}
+#	endif // ~ ENABLE_AVX2
+}
+
+bool setup_triangle_edges( TriangleSetup& aSetup, Surface const& aSurface, Vec2f aP0, Vec2f aP1, Vec2f aP2 ) noexcept
+{
+	if( !in_range_( aP0, aP1, aP2 ) )
+		return false;
+
+	bound_box_for_triangle box = bounding_box_for_triangle( aP0, aP1, aP2 );
+	clamping_box( box, aSurface );
+
+	return setup_edges_( aSetup, box, aP0, aP1, aP2 );
+}
+
+bool setup_triangle_edges( TriangleSetup& aSetup, TiledSurface const& aSurface, Vec2f aP0, Vec2f aP1, Vec2f aP2 ) noexcept
+{
+	if( !in_range_( aP0, aP1, aP2 ) )
+		return false;
+
+	// Same as clamping_box(), which only accepts a Surface
+	bound_box_for_triangle box = bounding_box_for_triangle( aP0, aP1, aP2 );
+	box.xmin = float(std::max( 0, int(std::floor( box.xmin )) ));
+	box.xmax = float(std::min( int(aSurface.get_width()) - 1, int(std::ceil( box.xmax )) - 1 ));
+	box.ymin = float(std::max( 0, int(std::floor( box.ymin )) ));
+	box.ymax = float(std::min( int(aSurface.get_height()) - 1, int(std::ceil( box.ymax )) - 1 ));
+
+	return setup_edges_( aSetup, box, aP0, aP1, aP2 );
+}
+
+bool setup_triangle( TriangleSetup& aSetup, Surface const& aSurface, Vec2f aP0, Vec2f aP1, Vec2f aP2, ColorF const& aC0, ColorF const& aC1, ColorF const& aC2 ) noexcept
+{
+	if( !setup_triangle_edges( aSetup, aSurface, aP0, aP1, aP2 ) )
+		return false;
+
+	// Degenerate (unsnapped) triangles that still cover pixels after
+	// snapping get a flat color.
+	ColorF colorDx{ 0.f, 0.f, 0.f }, colorDy{ 0.f, 0.f, 0.f };
+	triangle_color_gradients( aP0, aP1, aP2, aC0, aC1, aC2, colorDx, colorDy );
+
+	setup_triangle_colors( aSetup, aP0, aC0, colorDx, colorDy );
+	return true;
+}
+
+bool triangle_color_gradients( Vec2f aP0, Vec2f aP1, Vec2f aP2, ColorF const& aC0, ColorF const& aC1, ColorF const& aC2, ColorF& aColorDx, ColorF& aColorDy ) noexcept
+{
+	// The gradients are computed from the unsnapped vertices in double
+	// precision; the result is only stored as floats.
+	double const ux1 = double(aP1.x) - aP0.x, uy1 = double(aP1.y) - aP0.y;
+	double const ux2 = double(aP2.x) - aP0.x, uy2 = double(aP2.y) - aP0.y;
+	double const det = ux1 * uy2 - ux2 * uy1;
+
+	if( 0.0 == det )
+		return false;
+
+	aColorDx = ColorF{
+		plane_gradient_( aC1.r - aC0.r, aC2.r - aC0.r, uy1, uy2, det ),
+		plane_gradient_( aC1.g - aC0.g, aC2.g - aC0.g, uy1, uy2, det ),
+		plane_gradient_( aC1.b - aC0.b, aC2.b - aC0.b, uy1, uy2, det )
+	};
+	aColorDy = ColorF{
+		plane_gradient_( aC2.r - aC0.r, aC1.r - aC0.r, ux2, ux1, det ),
+		plane_gradient_( aC2.g - aC0.g, aC1.g - aC0.g, ux2, ux1, det ),
+		plane_gradient_( aC2.b - aC0.b, aC1.b - aC0.b, ux2, ux1, det )
+	};
+
+	return true;
+}
+
+void setup_triangle_colors( TriangleSetup& aSetup, Vec2f aP0, ColorF const& aC0, ColorF const& aColorDx, ColorF const& aColorDy ) noexcept
+{
+	aSetup.colorDx = aColorDx;
+	aSetup.colorDy = aColorDy;
+
+	double const ox = aSetup.xmin + 0.5 - aP0.x;
+	double const oy = aSetup.ymin + 0.5 - aP0.y;
+	aSetup.color = ColorF{
+		float(aC0.r + double(aColorDx.r) * ox + double(aColorDy.r) * oy),
+		float(aC0.g + double(aColorDx.g) * ox + double(aColorDy.g) * oy),
+		float(aC0.b + double(aColorDx.b) * ox + double(aColorDy.b) * oy)
+	};
+}
+
+void rasterize_triangle_edges( Surface& aSurface, TriangleSetup const& aSetup )
+{
+	std::int64_t row0 = aSetup.edge[0];
+	std::int64_t row1 = aSetup.edge[1];
+	std::int64_t row2 = aSetup.edge[2];
+
+	for( int y = aSetup.ymin; y <= aSetup.ymax; ++y )
+	{
+		ColorF const rowColor = triangle_color_row( aSetup, y );
+		std::uint8_t* const rowPtr = surface_row_ptr( aSurface, Surface::Index(y) );
+
+		std::int64_t e0 = row0, e1 = row1, e2 = row2;
+		for( int x = aSetup.xmin; x <= aSetup.xmax; ++x )
+		{
+			// All three are non-negative iff the sign bit of their OR is clear
+			if( (e0 | e1 | e2) >= 0 )
+				store_pixel_( rowPtr, x, triangle_color_at( aSetup, rowColor, x ) );
+
+			e0 += aSetup.edgeDx[0];
+			e1 += aSetup.edgeDx[1];
+			e2 += aSetup.edgeDx[2];
+		}
+
+		row0 += aSetup.edgeDy[0];
+		row1 += aSetup.edgeDy[1];
+		row2 += aSetup.edgeDy[2];
+	}
+}
+
+void shade_triangle_span( Surface& aSurface, TriangleSetup const& aSetup, int aY, int aBegin, int aEnd )
+{
+	ColorF const rowColor = triangle_color_row( aSetup, aY );
+	std::uint8_t* const rowPtr = surface_row_ptr( aSurface, Surface::Index(aY) );
+
+	for( int x = aBegin; x <= aEnd; ++x )
+		store_pixel_( rowPtr, x, triangle_color_at( aSetup, rowColor, x ) );
+}
+
+void rasterize_triangle_spans( Surface& aSurface, TriangleSetup const& aSetup )
+{
+	std::int64_t row[3] = { aSetup.edge[0], aSetup.edge[1], aSetup.edge[2] };
+
+	for( int y = aSetup.ymin; y <= aSetup.ymax; ++y )
+	{
+		int begin, end;
+		if( triangle_row_span( aSetup, row, begin, end ) )
+			shade_triangle_span( aSurface, aSetup, y, begin, end );
+
+		row[0] += aSetup.edgeDy[0];
+		row[1] += aSetup.edgeDy[1];
+		row[2] += aSetup.edgeDy[2];
+	}
+}
+
+void rasterize_triangle_solid( Surface& aSurface, TriangleSetup const& aSetup, std::uint32_t aRGBx )
+{
+	std::int64_t row[3] = { aSetup.edge[0], aSetup.edge[1], aSetup.edge[2] };
+
+	for( int y = aSetup.ymin; y <= aSetup.ymax; ++y )
+	{
+		int begin, end;
+		if( triangle_row_span( aSetup, row, begin, end ) )
+			fill_span( surface_row_ptr( aSurface, Surface::Index(y) ), begin, end, aRGBx );
+
+		row[0] += aSetup.edgeDy[0];
+		row[1] += aSetup.edgeDy[1];
+		row[2] += aSetup.edgeDy[2];
+	}
+}
+
+void rasterize_triangle_fan( Surface& aSurface, TriangleSetup const* aSetups, std::size_t aCount )
+{
+#	if DRAW2D_CFG_ENABLE_AVX2
+	if( cpu_has_avx2() )
+	{
+		walk_triangle_rows_( aSetups, aCount, [&aSurface] (TriangleSetup const& aSetup, int aY, int aBegin, int aEnd) {
+			shade_triangle_span_avx2( aSurface, aSetup, aY, aBegin, aEnd );
+		} );
+		return;
+	}
+#	endif // ~ ENABLE_AVX2
+
+	walk_triangle_rows_( aSetups, aCount, [&aSurface] (TriangleSetup const& aSetup, int aY, int aBegin, int aEnd) {
+		shade_triangle_span( aSurface, aSetup, aY, aBegin, aEnd );
+	} );
+}
+
+void rasterize_triangle_fan_solid( Surface& aSurface, TriangleSetup const* aSetups, std::size_t aCount, std::uint32_t aRGBx )
+{
+	walk_triangle_rows_( aSetups, aCount, [&aSurface,aRGBx] (TriangleSetup const&, int aY, int aBegin, int aEnd) {
+		fill_span( surface_row_ptr( aSurface, Surface::Index(aY) ), aBegin, aEnd, aRGBx );
+	} );
+}
+
+void shade_triangle_span( TiledSurface& aSurface, TriangleSetup const& aSetup, int aY, int aBegin, int aEnd )
+{
+	constexpr int kTile = int(TiledSurface::kTileSize);
+
+	ColorF const rowColor = triangle_color_row( aSetup, aY );
+
+	// One tile row at a time; consecutive tile rows of the span are
+	// TiledSurface::kTileBytes apart (see shade_triangle_span_avx2()).
+	int const first = aBegin - aBegin % kTile;
+	std::uint8_t* tileRow = aSurface.get_tile_row_ptr( TiledSurface::Index(aBegin), TiledSurface::Index(aY) );
+
+	for( int tileX = first; tileX <= aEnd; tileX += kTile )
+	{
+		int const begin = std::max( aBegin, tileX );
+		int const end = std::min( aEnd, tileX + kTile - 1 );
+
+		for( int x = begin; x <= end; ++x )
+			store_pixel_( tileRow, x - tileX, triangle_color_at( aSetup, rowColor, x ) );
+
+		tileRow += TiledSurface::kTileBytes;
+	}
+}
+
+void rasterize_triangle_fan( TiledSurface& aSurface, TriangleSetup const* aSetups, std::size_t aCount )
+{
+#	if DRAW2D_CFG_ENABLE_AVX2
+	if( cpu_has_avx2() )
+	{
+		walk_triangle_rows_( aSetups, aCount, [&aSurface] (TriangleSetup const& aSetup, int aY, int aBegin, int aEnd) {
+			shade_triangle_span_avx2( aSurface, aSetup, aY, aBegin, aEnd );
+		} );
+		return;
+	}
+#	endif // ~ ENABLE_AVX2
+
+	walk_triangle_rows_( aSetups, aCount, [&aSurface] (TriangleSetup const& aSetup, int aY, int aBegin, int aEnd) {
+		shade_triangle_span( aSurface, aSetup, aY, aBegin, aEnd );
+	} );
+}
+
+void rasterize_triangle_fan_solid( TiledSurface& aSurface, TriangleSetup const* aSetups, std::size_t aCount, std::uint32_t aRGBx )
+{
+	constexpr int kTile = int(TiledSurface::kTileSize);
+
+	walk_triangle_rows_( aSetups, aCount, [&aSurface,aRGBx] (TriangleSetup const&, int aY, int aBegin, int aEnd) {
+		// One fill per tile row that the span touches
+		for( int x = aBegin; x <= aEnd; )
+		{
+			int const tileX = x - x % kTile;
+			int const last = std::min( aEnd, tileX + kTile - 1 );
+
+			std::uint8_t* const tileRow = aSurface.get_tile_row_ptr( TiledSurface::Index(x), TiledSurface::Index(aY) );
+			fill_span( tileRow, x - tileX, last - tileX, aRGBx );
+
+			x = last + 1;
+		}
+	} );
+}
+
+void rasterize_triangle_blocks( Surface& aSurface, TriangleSetup const& aSetup )
+{
+	constexpr int kBlock = kTriangleBlockSize;
+
+	for( int by = aSetup.ymin - aSetup.ymin % kBlock; by <= aSetup.ymax; by += kBlock )
+	{
+		int const y0 = std::max( by, aSetup.ymin );
+		int const y1 = std::min( by + kBlock - 1, aSetup.ymax );
+
+		for( int bx = aSetup.xmin - aSetup.xmin % kBlock; bx <= aSetup.xmax; bx += kBlock )
+		{
+			int const x0 = std::max( bx, aSetup.xmin );
+			int const x1 = std::min( bx + kBlock - 1, aSetup.xmax );
+
+			BlockCoverage_ const coverage = classify_block_( aSetup, x0, y0, x1, y1 );
+			if( BlockCoverage_::none == coverage )
+				continue;
+
+			std::int64_t row[3];
+			edges_at_( aSetup, x0, y0, row );
+
+			for( int y = y0; y <= y1; ++y )
+			{
+				ColorF const rowColor = triangle_color_row( aSetup, y );
+				std::uint8_t* const rowPtr = surface_row_ptr( aSurface, Surface::Index(y) );
+
+				std::int64_t e0 = row[0], e1 = row[1], e2 = row[2];
+				for( int x = x0; x <= x1; ++x )
+				{
+					if( BlockCoverage_::full == coverage || (e0 | e1 | e2) >= 0 )
+						store_pixel_( rowPtr, x, triangle_color_at( aSetup, rowColor, x ) );
+
+					e0 += aSetup.edgeDx[0];
+					e1 += aSetup.edgeDx[1];
+					e2 += aSetup.edgeDx[2];
+				}
+
+				row[0] += aSetup.edgeDy[0];
+				row[1] += aSetup.edgeDy[1];
+				row[2] += aSetup.edgeDy[2];
+			}
+		}
+	}
+}
+
+bool triangle_row_span( TriangleSetup const& aSetup, std::int64_t const aRow[3], int& aBegin, int& aEnd ) noexcept
+{
+	return convex_row_span<3>( aRow, aSetup.edgeDx, aSetup.xmin, aSetup.xmax, aBegin, aEnd );
+}
+
+#if DRAW2D_CFG_ENABLE_AVX2
+DRAW2D_TARGET_AVX2
+void rasterize_triangle_edges_avx2( Surface& aSurface, TriangleSetup const& aSetup )
+{
+	std::int64_t row[3] = { aSetup.edge[0], aSetup.edge[1], aSetup.edge[2] };
+
+	for( int y = aSetup.ymin; y <= aSetup.ymax; ++y )
+	{
+		ColorF const rowColor = triangle_color_row( aSetup, y );
+		std::uint8_t* const rowPtr = surface_row_ptr( aSurface, Surface::Index(y) );
+
+		std::int64_t e[3] = { row[0], row[1], row[2] };
+		for( int x = aSetup.xmin; x <= aSetup.xmax; x += 8 )
+		{
+			if( int const covered = coverage8_avx2_( aSetup, e, aSetup.xmax - x + 1 ) )
+				shade8_avx2_( rowPtr, x, lanes_from_bits_avx2_( covered ), aSetup, rowColor );
+
+			e[0] += 8*aSetup.edgeDx[0];
+			e[1] += 8*aSetup.edgeDx[1];
+			e[2] += 8*aSetup.edgeDx[2];
+		}
+
+		row[0] += aSetup.edgeDy[0];
+		row[1] += aSetup.edgeDy[1];
+		row[2] += aSetup.edgeDy[2];
+	}
+}
+
+DRAW2D_TARGET_AVX2
+void shade_triangle_span_avx2( Surface& aSurface, TriangleSetup const& aSetup, int aY, int aBegin, int aEnd )
+{
+	ColorF const rowColor = triangle_color_row( aSetup, aY );
+	std::uint8_t* const rowPtr = surface_row_ptr( aSurface, Surface::Index(aY) );
+
+	for( int x = aBegin; x <= aEnd; x += 8 )
+		shade8_avx2_( rowPtr, x, first_lanes_avx2_( aEnd - x + 1 ), aSetup, rowColor );
+}
+
+DRAW2D_TARGET_AVX2
+void shade_triangle_span_avx2( TiledSurface& aSurface, TriangleSetup const& aSetup, int aY, int aBegin, int aEnd )
+{
+	constexpr int kTile = int(TiledSurface::kTileSize);
+	static_assert( kTile == 8, "A tile row must be a single AVX2 register" );
+
+	ColorF const rowColor = triangle_color_row( aSetup, aY );
+
+	// Split the span at tile boundaries. Each part is one masked store to a
+	// tile row, with the lanes before aBegin and after aEnd disabled. The
+	// tile rows of a span are TiledSurface::kTileBytes apart.
+	int const first = aBegin - aBegin % kTile;
+	std::uint8_t* tileRow = aSurface.get_tile_row_ptr( TiledSurface::Index(aBegin), TiledSurface::Index(aY) );
+
+	__m256i mask = _mm256_andnot_si256( first_lanes_avx2_( aBegin - first ), _mm256_set1_epi32( -1 ) );
+	for( int tileX = first; tileX <= aEnd; tileX += kTile )
+	{
+		if( aEnd - tileX < kTile )
+			mask = _mm256_and_si256( mask, first_lanes_avx2_( aEnd - tileX + 1 ) );
+
+		shade8_to_avx2_( tileRow, tileX, mask, aSetup, rowColor );
+
+		tileRow += TiledSurface::kTileBytes;
+		mask = _mm256_set1_epi32( -1 );
+	}
+}
+
+DRAW2D_TARGET_AVX2
+void rasterize_triangle_spans_avx2( Surface& aSurface, TriangleSetup const& aSetup )
+{
+	std::int64_t row[3] = { aSetup.edge[0], aSetup.edge[1], aSetup.edge[2] };
+
+	for( int y = aSetup.ymin; y <= aSetup.ymax; ++y )
+	{
+		int begin, end;
+		if( triangle_row_span( aSetup, row, begin, end ) )
+			shade_triangle_span_avx2( aSurface, aSetup, y, begin, end );
+
+		row[0] += aSetup.edgeDy[0];
+		row[1] += aSetup.edgeDy[1];
+		row[2] += aSetup.edgeDy[2];
+	}
+}
+
+DRAW2D_TARGET_AVX2
+void rasterize_triangle_blocks_avx2( Surface& aSurface, TriangleSetup const& aSetup )
+{
+	constexpr int kBlock = kTriangleBlockSize;
+	static_assert( kBlock <= 8, "A block row must fit into a single AVX2 register" );
+
+	for( int by = aSetup.ymin - aSetup.ymin % kBlock; by <= aSetup.ymax; by += kBlock )
+	{
+		int const y0 = std::max( by, aSetup.ymin );
+		int const y1 = std::min( by + kBlock - 1, aSetup.ymax );
+
+		for( int bx = aSetup.xmin - aSetup.xmin % kBlock; bx <= aSetup.xmax; bx += kBlock )
+		{
+			int const x0 = std::max( bx, aSetup.xmin );
+			int const x1 = std::min( bx + kBlock - 1, aSetup.xmax );
+
+			BlockCoverage_ const coverage = classify_block_( aSetup, x0, y0, x1, y1 );
+			if( BlockCoverage_::none == coverage )
+				continue;
+
+			std::int64_t row[3];
+			edges_at_( aSetup, x0, y0, row );
+
+			__m256i const fullMask = first_lanes_avx2_( x1 - x0 + 1 );
+			for( int y = y0; y <= y1; ++y )
+			{
+				ColorF const rowColor = triangle_color_row( aSetup, y );
+				std::uint8_t* const rowPtr = surface_row_ptr( aSurface, Surface::Index(y) );
+
+				if( BlockCoverage_::full == coverage )
+				{
+					shade8_avx2_( rowPtr, x0, fullMask, aSetup, rowColor );
+				}
+				else if( int const covered = coverage8_avx2_( aSetup, row, x1 - x0 + 1 ) )
+				{
+					shade8_avx2_( rowPtr, x0, lanes_from_bits_avx2_( covered ), aSetup, rowColor );
+				}
+
+				row[0] += aSetup.edgeDy[0];
+				row[1] += aSetup.edgeDy[1];
+				row[2] += aSetup.edgeDy[2];
+			}
+		}
+	}
+}
+#endif // ~ ENABLE_AVX2
@@ -0,0 +1,226 @@
+#ifndef TRIANGLE_HPP_80E0955C_CE8E_4DBB_A2F7_1B044981C884
+#define TRIANGLE_HPP_80E0955C_CE8E_4DBB_A2F7_1B044981C884
+
+// Triangle rasterization internals. draw_triangle_interp() is a thin wrapper
+// around the functions declared here.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "cpu.hpp"
+#include "forward.hpp"
+#include "color.hpp"
+
+#include "../vmlib/vec2.hpp"
+
+/* Compile-time configuration:
+ * Pick the traversal used by draw_triangle_interp(). EDGES walks the whole
+ * (clamped) bounding box and tests each pixel against the edge functions.
+ * SPANS computes the exact extent of the triangle on each row from the edge
+ * functions and only visits the covered pixels. BLOCKS classifies 8x8 pixel
+ * blocks of the bounding box first: blocks that are fully outside of the
+ * triangle are skipped, blocks that are fully inside are filled without any
+ * per-pixel tests, and only the remaining blocks are tested per pixel. All
+ * produce identical results; the functions for each are declared below, so
+ * that they can be compared directly.
+ *
+ * Either traversal uses an AVX2 kernel that processes 8 horizontally adjacent
+ * pixels at once if the CPU supports it (see cpu.hpp). The AVX2 kernels
+ * produce the same pixels as the scalar ones.
+ */
+#define DRAW2D_CFG_TRIANGLE_EDGES 1
+#define DRAW2D_CFG_TRIANGLE_SPANS 2
+#define DRAW2D_CFG_TRIANGLE_BLOCKS 3
+
+#define DRAW2D_CFG_TRIANGLE_MODE DRAW2D_CFG_TRIANGLE_SPANS
+
+/* Vertex positions are snapped to a fixed point grid with this many fractional
+ * bits before the edge functions are set up. 8 bits (1/256th of a pixel) is
+ * in line with what GPUs use.
+ *
+ * Edge function values are stored as 64-bit integers. This supports vertex
+ * coordinates up to +/- kTriangleMaxCoord pixels without overflow; triangles
+ * with vertices beyond that are discarded by setup_triangle().
+ */
+constexpr int kTriangleSubpixelBits = 8;
+constexpr std::int64_t kTriangleSubpixelOne = std::int64_t(1) << kTriangleSubpixelBits;
+
+constexpr float kTriangleMaxCoord = float(1 << 22);
+
+// Block size used by the BLOCKS traversal. Blocks are aligned to multiples of
+// this in surface coordinates.
+constexpr int kTriangleBlockSize = 8;
+
+/** Triangle setup
+ *
+ * Per-triangle data computed once by setup_triangle(). The three edge
+ * functions are affine in the pixel coordinates, so they are stored as their
+ * value at the center of the first pixel of the (clamped) bounding box, and
+ * the increments for stepping one pixel in x and y. Coverage is given by all
+ * three edge functions being non-negative. The top-left fill rule is folded
+ * into the edge function constants, so triangles sharing an edge never both
+ * write a pixel on that edge.
+ *
+ * Colors are linear and interpolated in floating point. The color plane is
+ * stored as the color at the center of pixel (xmin,ymin) and per-pixel
+ * gradients. Use triangle_color_row() and triangle_color_at() to evaluate it,
+ * so that different traversal orders produce identical results.
+ */
+struct TriangleSetup
+{
+	std::int64_t edge[3]; // edge functions at the center of (xmin,ymin)
+	std::int64_t edgeDx[3]; // increment per pixel in x
+	std::int64_t edgeDy[3]; // increment per pixel in y
+
+	int xmin, xmax; // inclusive pixel bounds, clamped to the surface
+	int ymin, ymax;
+
+	ColorF color; // linear color at the center of (xmin,ymin)
+	ColorF colorDx; // color increment per pixel in x
+	ColorF colorDy; // color increment per pixel in y
+};
+
+/** Set up a triangle for rasterization
+ *
+ * Returns false if the triangle does not cover any pixels of aSurface: it is
+ * degenerate (zero area after snapping), entirely outside of the surface, or
+ * has vertices outside of the supported coordinate range. Either winding
+ * order is accepted.
+ */
+bool setup_triangle(
+	TriangleSetup&,
+	Surface const&,
+	Vec2f aP0, Vec2f aP1, Vec2f aP2,
+	ColorF const& aC0, ColorF const& aC1, ColorF const& aC2
+) noexcept;
+
+// As setup_triangle(), but only sets up the edge functions and bounds. Use
+// with rasterize_triangle_solid(). The TiledSurface version clamps to the
+// tiled surface instead; the setup is otherwise the same.
+bool setup_triangle_edges( TriangleSetup&, Surface const&, Vec2f aP0, Vec2f aP1, Vec2f aP2 ) noexcept;
+bool setup_triangle_edges( TriangleSetup&, TiledSurface const&, Vec2f aP0, Vec2f aP1, Vec2f aP2 ) noexcept;
+
+/** Color plane of a triangle
+ *
+ * setup_triangle() is setup_triangle_edges() followed by these two.
+ * triangle_color_gradients() computes the per-pixel color gradients of the
+ * triangle; it returns false (and leaves the outputs unchanged) if the
+ * triangle is degenerate. setup_triangle_colors() stores the gradients and
+ * the color at the center of the first pixel in the setup; the edges must
+ * have been set up already.
+ *
+ * The gradients only depend on the triangle's shape, so they can be computed
+ * ahead of time and transformed as needed (see TriangleFan).
+ */
+bool triangle_color_gradients(
+	Vec2f aP0, Vec2f aP1, Vec2f aP2,
+	ColorF const& aC0, ColorF const& aC1, ColorF const& aC2,
+	ColorF& aColorDx, ColorF& aColorDy
+) noexcept;
+
+void setup_triangle_colors( TriangleSetup&, Vec2f aP0, ColorF const& aC0, ColorF const& aColorDx, ColorF const& aColorDy ) noexcept;
+
+/** Rasterize a triangle that was set up with setup_triangle()
+ *
+ * Uses the traversal selected by DRAW2D_CFG_TRIANGLE_MODE. Covered pixels
+ * receive the interpolated color.
+ */
+void rasterize_triangle( Surface&, TriangleSetup const& );
+
+// Walk the bounding box in row order and step the edge functions per pixel.
+void rasterize_triangle_edges( Surface&, TriangleSetup const& );
+
+// Fill the exact span covered by the triangle on each row.
+void rasterize_triangle_spans( Surface&, TriangleSetup const& );
+
+// Classify 8x8 blocks, and only test pixels in partially covered blocks.
+void rasterize_triangle_blocks( Surface&, TriangleSetup const& );
+
+/** Rasterize a triangle with a single color
+ *
+ * Covers the same pixels as rasterize_triangle(), but fills them with the
+ * packed color aRGBx (see pack_rgbx() in fill.hpp). Rows are filled with
+ * fill_span(). Only requires the edge functions (setup_triangle_edges()).
+ */
+void rasterize_triangle_solid( Surface&, TriangleSetup const&, std::uint32_t aRGBx );
+
+/** Rasterize several triangles in a single pass
+ *
+ * Intended for triangle fans, whose triangles share most of their rows. The
+ * rows of the union of the triangles' bounding boxes are visited once; each
+ * row fills the spans of the triangles that are active on it (see
+ * triangle_row_span()). Triangles are activated at their first row and
+ * retired after their last one, so rows are not rescanned per triangle.
+ *
+ * The result is identical to rasterizing the triangles one after another in
+ * order: where triangles overlap, the later one wins. The _solid version
+ * fills all triangles with the packed color aRGBx, and only requires the
+ * edge functions.
+ */
+void rasterize_triangle_fan( Surface&, TriangleSetup const*, std::size_t aCount );
+void rasterize_triangle_fan_solid( Surface&, TriangleSetup const*, std::size_t aCount, std::uint32_t aRGBx );
+
+// Shade the pixels [aBegin, aEnd] of row aY with the triangle's colors.
+void shade_triangle_span( Surface&, TriangleSetup const&, int aY, int aBegin, int aEnd );
+
+/** Rasterize triangles to a tiled surface
+ *
+ * Same as the Surface versions above, and produces the same pixels. Spans
+ * are split at tile boundaries, and each part is written to a single tile
+ * row (see TiledSurface).
+ */
+void rasterize_triangle_fan( TiledSurface&, TriangleSetup const*, std::size_t aCount );
+void rasterize_triangle_fan_solid( TiledSurface&, TriangleSetup const*, std::size_t aCount, std::uint32_t aRGBx );
+
+void shade_triangle_span( TiledSurface&, TriangleSetup const&, int aY, int aBegin, int aEnd );
+
+#if DRAW2D_CFG_ENABLE_AVX2
+// AVX2 versions of the above. Only call these if cpu_has_avx2() is true.
+void rasterize_triangle_edges_avx2( Surface&, TriangleSetup const& );
+void rasterize_triangle_spans_avx2( Surface&, TriangleSetup const& );
+void rasterize_triangle_blocks_avx2( Surface&, TriangleSetup const& );
+
+void shade_triangle_span_avx2( Surface&, TriangleSetup const&, int aY, int aBegin, int aEnd );
+void shade_triangle_span_avx2( TiledSurface&, TriangleSetup const&, int aY, int aBegin, int aEnd );
+#endif // ~ ENABLE_AVX2
+
+/** Compute the pixels covered by a triangle on a single row
+ *
+ * aRow holds the three edge functions at the center of pixel (xmin,y) for the
+ * row in question. Returns false if the row is not covered at all. Otherwise
+ * aBegin and aEnd are set to the first and last covered pixel (inclusive);
+ * these are exactly the pixels for which all three edge functions are
+ * non-negative.
+ */
+bool triangle_row_span( TriangleSetup const&, std::int64_t const aRow[3], int& aBegin, int& aEnd ) noexcept;
+
+/** Edge functions of convex polygons
+ *
+ * The parts of the triangle setup and traversal that do not depend on the
+ * number of edges; draw_line_wide() uses these for its quads, so that both
+ * follow the same snapping and fill rules.
+ *
+ * snap_triangle_coord() snaps a coordinate to the kTriangleSubpixelBits
+ * grid. setup_convex_edges() sets up the tEdges edge functions (see
+ * TriangleSetup) of the convex polygon with the snapped vertices aX, aY at
+ * the center of pixel (aXMin,aYMin). The vertices may be in either order;
+ * the polygon is oriented counter-clockwise starting at the first vertex.
+ * Returns false if the polygon has zero area. convex_row_span() is
+ * triangle_row_span() for tEdges edges, for the pixels [aXMin, aXMax].
+ */
+std::int64_t snap_triangle_coord( float ) noexcept;
+
+template< int tEdges >
+bool setup_convex_edges( std::int64_t const* aX, std::int64_t const* aY, int aXMin, int aYMin, std::int64_t* aEdge, std::int64_t* aEdgeDx, std::int64_t* aEdgeDy ) noexcept;
+
+template< int tEdges >
+bool convex_row_span( std::int64_t const* aRow, std::int64_t const* aEdgeDx, int aXMin, int aXMax, int& aBegin, int& aEnd ) noexcept;
+
+
+// Helpers to evaluate the color plane:
+
+ColorF triangle_color_row( TriangleSetup const&, int aY ) noexcept;
+ColorU8_sRGB triangle_color_at( TriangleSetup const&, ColorF const& aRow, int aX ) noexcept;
+
+#include "triangle.inl"
+#endif // TRIANGLE_HPP_80E0955C_CE8E_4DBB_A2F7_1B044981C884
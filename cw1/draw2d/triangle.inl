@@ -0,0 +1,149 @@
+#include <algorithm>
+
+#include <cmath>
+
+/* The color helpers use std::fma() explicitly. Whether or not the compiler
+ * contracts a separate multiply and add into a FMA is up to its settings, and
+ * the result of the two differs in the last bit. Spelling out the FMA makes
+ * the computed colors independent of that (and of the traversal order).
+ */
+inline
+ColorF triangle_color_row( TriangleSetup const& aSetup, int aY ) noexcept
+{
+	float const dy = float(aY - aSetup.ymin);
+	return ColorF{
+		std::fma( aSetup.colorDy.r, dy, aSetup.color.r ),
+		std::fma( aSetup.colorDy.g, dy, aSetup.color.g ),
+		std::fma( aSetup.colorDy.b, dy, aSetup.color.b )
+	};
+}
+
+inline
+ColorU8_sRGB triangle_color_at( TriangleSetup const& aSetup, ColorF const& aRow, int aX ) noexcept
+{
+	// Pixels inside of the triangle should always get a color in [0,1], but
+	// rounding can push the value slightly outside of that.
+	float const dx = float(aX - aSetup.xmin);
+	return linear_to_srgb( ColorF{
+		std::clamp( std::fma( aSetup.colorDx.r, dx, aRow.r ), 0.f, 1.f ),
+		std::clamp( std::fma( aSetup.colorDx.g, dx, aRow.g ), 0.f, 1.f ),
+		std::clamp( std::fma( aSetup.colorDx.b, dx, aRow.b ), 0.f, 1.f )
+	} );
+}
+
+inline
+std::int64_t snap_triangle_coord( float aValue ) noexcept
+{
+	return std::int64_t(std::floor( aValue * float(kTriangleSubpixelOne) + 0.5f ));
+}
+
+template< int tEdges >
+bool setup_convex_edges( std::int64_t const* aX, std::int64_t const* aY, int aXMin, int aYMin, std::int64_t* aEdge, std::int64_t* aEdgeDx, std::int64_t* aEdgeDy ) noexcept
+{
+	// Twice the signed area (shoelace formula)
+	std::int64_t area = 0;
+	for( int i = 0; i < tEdges; ++i )
+		area += aX[i] * aY[(i+1) % tEdges] - aX[(i+1) % tEdges] * aY[i];
+
+	if( 0 == area )
+		return false;
+
+	// Edge functions E(p) = cross(b-a, p-a) for the edges a->b, evaluated at
+	// the center of pixel (aXMin,aYMin).
+	std::int64_t const px = aXMin * kTriangleSubpixelOne + kTriangleSubpixelOne/2;
+	std::int64_t const py = aYMin * kTriangleSubpixelOne + kTriangleSubpixelOne/2;
+
+	for( int i = 0; i < tEdges; ++i )
+	{
+		int const a = area > 0 ? i : (tEdges - i) % tEdges;
+		int const b = area > 0 ? (i+1) % tEdges : (tEdges - i - 1) % tEdges;
+
+		std::int64_t const dx = aX[b] - aX[a];
+		std::int64_t const dy = aY[b] - aY[a];
+
+		aEdge[i] = dx * (py - aY[a]) - dy * (px - aX[a]);
+		aEdgeDx[i] = -dy * kTriangleSubpixelOne;
+		aEdgeDy[i] = dx * kTriangleSubpixelOne;
+
+		// Pixels exactly on an edge are only covered by top and left edges.
+		// The surface's y axis points up (row 0 is at the bottom of the
+		// window), so left edges point down, and top edges are horizontal
+		// and point left. Since E is an integer, E > 0 is the same as
+		// E-1 >= 0.
+		bool const topLeft = dy < 0 || (0 == dy && dx < 0);
+		if( !topLeft )
+			aEdge[i] -= 1;
+	}
+
+	return true;
+}
+
+template< int tEdges >
+bool convex_row_span( std::int64_t const* aRow, std::int64_t const* aEdgeDx, int aXMin, int aXMax, int& aBegin, int& aEnd ) noexcept
+{
+	// Each edge function is E(x) = aRow + dx * (x - xmin) along the row. For
+	// dx > 0 the condition E(x) >= 0 gives a lower bound on x, for dx < 0 an
+	// upper bound. Bounds are computed relative to xmin.
+	std::int64_t lo = 0;
+	std::int64_t hi = aXMax - aXMin;
+
+	for( int i = 0; i < tEdges; ++i )
+	{
+		std::int64_t const e = aRow[i];
+		std::int64_t const dx = aEdgeDx[i];
+
+		if( dx > 0 )
+		{
+			if( e < 0 )
+				lo = std::max( lo, (-e + dx - 1) / dx ); // ceil(-e/dx)
+		}
+		else if( dx < 0 )
+		{
+			if( e < 0 )
+				return false;
+
+			hi = std::min( hi, e / -dx ); // floor(e/-dx)
+		}
+		else if( e < 0 )
+		{
+			return false;
+		}
+	}
+
+	if( lo > hi )
+		return false;
+
+	aBegin = aXMin + int(lo);
+	aEnd = aXMin + int(hi);
+	return true;
+}
+
+inline
+void rasterize_triangle( Surface& aSurface, TriangleSetup const& aSetup )
+{
+#	if DRAW2D_CFG_TRIANGLE_MODE == DRAW2D_CFG_TRIANGLE_EDGES
+#	if DRAW2D_CFG_ENABLE_AVX2
+	if( cpu_has_avx2() )
+		return rasterize_triangle_edges_avx2( aSurface, aSetup );
+#	endif // ~ ENABLE_AVX2
+
+	rasterize_triangle_edges( aSurface, aSetup );
+
+#	elif DRAW2D_CFG_TRIANGLE_MODE == DRAW2D_CFG_TRIANGLE_SPANS
+#	if DRAW2D_CFG_ENABLE_AVX2
+	if( cpu_has_avx2() )
+		return rasterize_triangle_spans_avx2( aSurface, aSetup );
+#	endif // ~ ENABLE_AVX2
+
+	rasterize_triangle_spans( aSurface, aSetup );
+
+#	elif DRAW2D_CFG_TRIANGLE_MODE == DRAW2D_CFG_TRIANGLE_BLOCKS
+#	if DRAW2D_CFG_ENABLE_AVX2
+	if( cpu_has_avx2() )
+		return rasterize_triangle_blocks_avx2( aSurface, aSetup );
+#	endif // ~ ENABLE_AVX2
+
+	rasterize_triangle_blocks( aSurface, aSetup );
+
+#	endif // ~ DRAW2D_CFG_TRIANGLE_MODE
+}
@@ -1,9 +1,27 @@
 #include <benchmark/benchmark.h>
 
+#include <random>
+#include <thread>
+#include <vector>
+#include <numbers>
+#include <algorithm>
+
+#include <cmath>
+#include <cstdint>
+
 #include "../draw2d/draw.hpp"
+#include "../draw2d/fill.hpp"
+#include "../draw2d/line.hpp"
+#include "../draw2d/shape.hpp"
+#include "../draw2d/storage.hpp"
 #include "../draw2d/draw-ex.hpp"
 #include "../draw2d/surface-ex.hpp"
 
+#include "../main/defaults.hpp"
+#include "../main/spaceship.hpp"
+
+#include "../vmlib/mat22.hpp"
+
 #define COLOR {255,255,255}
 #define SURF 1920, 1080
 
@@ -129,6 +147,25 @@ namespace // this allows encapsulation of helper functions
 			}
 	}
 
+	// Same lines as benchmark_draw_ex_line_solid, drawn from both ends at
+	// once (see draw_line_octant_symmetric()).
+	void benchmark_draw_ex_line_symmetric(	benchmark::State& aState ) {
+
+			SurfaceEx surf(SURF);
+			surf.clear();
+
+			Vec2f p0 = {	0.f, 0.f };
+			Vec2f	p1;
+			p1.x = static_cast<float>(aState.range(0));
+			p1.y = static_cast<float>(aState.range(1));
+
+			for ( auto _ : aState )
+			{
+				draw_ex_line_solid_symmetric( surf, p0, p1, COLOR ); 
+				benchmark::ClobberMemory(); 
+			}
+	}
+
 	void benchmark_draw_ex_diagonal(	benchmark::State& aState ) {
 		
 			SurfaceEx surf(SURF);
@@ -146,6 +183,407 @@ namespace // this allows encapsulation of helper functions
 			}
 	}
 
+	// Compare the line kernels from line.hpp on the same lines. The lines
+	// start in the middle of the surface and go in different directions, so
+	// that all of the octant kernels that draw_clip_line_solid() uses are
+	// covered. Setup is included, as it is part of each line.
+	void benchmark_line_kernel( benchmark::State& aState ) {
+
+		auto const kernel = aState.range(0);
+		auto const direction = aState.range(1);
+
+		Surface surf(SURF);
+		surf.clear();
+
+		Vec2f const offsets[] = {
+			{ 900.f, 90.f }, { 900.f, -90.f }, // shallow
+			{ 50.f, 500.f }, { -50.f, 500.f }, // steep
+			{ 500.f, 500.f }, { 500.f, -500.f } // 45 degrees
+		};
+
+		Vec2f const p0{ 960.f, 540.f };
+		Vec2f const p1 = p0 + 0.99f * offsets[direction];
+
+		std::uint32_t const rgbx = pack_rgbx( COLOR );
+
+		for (auto _ : aState)
+		{
+			LineSetup setup;
+			setup_line( setup, surf, p0, p1 );
+
+			switch( kernel )
+			{
+				case 0: rasterize_line_dda( surf, setup, rgbx ); break;
+				case 1: rasterize_line_runs( surf, setup, rgbx ); break;
+				case 2: rasterize_line_octants( surf, setup, rgbx ); break;
+				default: rasterize_line( surf, setup, rgbx ); break;
+			}
+
+			benchmark::ClobberMemory();
+		}
+	}
+
+	// A thick line, drawn with draw_line_wide() (method 0), or as width
+	// draw_line_solid() lines side by side (method 1), which is what callers
+	// did before.
+	void benchmark_line_wide( benchmark::State& aState ) {
+
+		auto const method = aState.range(0);
+		auto const width = static_cast<float>(aState.range(1));
+
+		Surface surf(SURF);
+		surf.clear();
+
+		Vec2f const p0{ 100.f, 100.f };
+		Vec2f const p1{ 1700.f, 900.f };
+
+		for (auto _ : aState)
+		{
+			if( 0 == method )
+			{
+				draw_line_wide( surf, p0, p1, width, COLOR );
+			}
+			else
+			{
+				// Offset along y, which is the minor axis of this line
+				for( int i = 0; i < int(width); ++i )
+				{
+					Vec2f const offset{ 0.f, float(i) - 0.5f * width };
+					draw_line_solid( surf, p0 + offset, p1 + offset, COLOR );
+				}
+			}
+
+			benchmark::ClobberMemory();
+		}
+	}
+
+	// Anti-aliased (method 1) versus aliased (method 0) lines, in the same
+	// directions as benchmark_slope.
+	void benchmark_line_aa( benchmark::State& aState ) {
+
+		auto const method = aState.range(0);
+		auto const direction = aState.range(1);
+
+		Surface surf(SURF);
+		surf.fill( { 40, 80, 120 } );
+
+		Vec2f const p0{ 10.5f, 20.25f };
+		Vec2f const offsets[] = { { 1000.f, 10.f }, { 10.f, 1000.f }, { 500.f, 500.f } };
+		Vec2f const p1 = p0 + offsets[direction];
+
+		for (auto _ : aState)
+		{
+			if( 0 == method )
+				draw_line_solid( surf, p0, p1, COLOR );
+			else
+				draw_line_aa( surf, p0, p1, COLOR );
+
+			benchmark::ClobberMemory();
+		}
+	}
+
+	// Many random lines on an 8K surface, drawn with draw_lines_solid_banded()
+	// with one band per thread. One thread is the same as draw_lines_solid().
+	// Measured in wall clock time (see UseRealTime() below), since the work is
+	// spread across threads; compare "lines" between thread counts.
+	void benchmark_lines_banded( benchmark::State& aState ) {
+
+		auto const threads = unsigned(aState.range(0));
+
+		Surface surf( 7680, 4320 );
+		surf.clear();
+
+		std::minstd_rand rng( 42 );
+		std::uniform_real_distribution<float> x( -500.f, 8180.f ), y( -500.f, 4820.f );
+
+		std::vector<LineSegment> segments( 5000 );
+		for( auto& segment : segments )
+			segment = LineSegment{ { x( rng ), y( rng ) }, { x( rng ), y( rng ) } };
+
+		for (auto _ : aState)
+		{
+			draw_lines_solid_banded( surf, segments, COLOR, threads );
+
+			benchmark::ClobberMemory();
+		}
+
+		aState.SetItemsProcessed( std::int64_t(segments.size()) * aState.iterations() );
+		aState.counters["cores"] = double(std::thread::hardware_concurrency());
+	}
+
+	// 1, 2 and 4 threads, and one per hardware thread
+	void banded_thread_counts_( benchmark::internal::Benchmark* aBenchmark ) {
+
+		std::vector<long> counts{ 1, 2, 4 };
+		counts.emplace_back( std::max( 1u, std::thread::hardware_concurrency() ) );
+
+		std::sort( counts.begin(), counts.end() );
+		counts.erase( std::unique( counts.begin(), counts.end() ), counts.end() );
+
+		for( long const count : counts )
+			aBenchmark->Arg( count );
+	}
+
+	/* Line workloads
+	 *
+	 * make_lines_() generates a fixed, seeded set of lines from a
+	 * distribution over length, slope and clip class, so that optimizations
+	 * are measured on a mix of lines rather than on a single best case. Two
+	 * rates are reported:
+	 *  - "lines": lines per second (items_per_second)
+	 *  - "pixels": pixels per second, estimated from the major extent of
+	 *    each line after clipping against the surface.
+	 */
+	enum class LineLength_ { shortLines, medium, longLines, mix };
+	enum class LineSlope_ { shallow, steep, diagonal, mix };
+	enum class LineClip_ { inside, partial, outside, mix };
+
+	bool inside_( Rect2F const& aArea, Vec2f aPoint )
+	{
+		return aPoint.x >= aArea.xmin && aPoint.x <= aArea.xmin + aArea.width
+			&& aPoint.y >= aArea.ymin && aPoint.y <= aArea.ymin + aArea.height;
+	}
+
+	LineClip_ classify_( Rect2F const& aArea, LineSegment const& aLine )
+	{
+		if( inside_( aArea, aLine.begin ) && inside_( aArea, aLine.end ) )
+			return LineClip_::inside;
+
+		Vec2f begin = aLine.begin, end = aLine.end;
+		return clip_line( aArea, begin, end ) ? LineClip_::partial : LineClip_::outside;
+	}
+
+	// Pixels that draw_line_solid() sets for the line (roughly)
+	double line_pixels_( Rect2F const& aArea, LineSegment const& aLine )
+	{
+		Vec2f begin = aLine.begin, end = aLine.end;
+		if( !clip_line( aArea, begin, end ) )
+			return 0.0;
+
+		return 1.0 + std::max( std::abs( std::round( end.x ) - std::round( begin.x ) ), std::abs( std::round( end.y ) - std::round( begin.y ) ) );
+	}
+
+	// Lengths are log-uniform within each class. Slopes are within 30
+	// degrees of the x (shallow) or y (steep) axis, or within 5 degrees of a
+	// diagonal, in any direction. The clip class mix is 80% inside, 15%
+	// partially inside and 5% outside of the surface.
+	std::vector<LineSegment> make_lines_( RNG& aRNG, std::size_t aCount, Rect2F const& aArea, LineLength_ aLength, LineSlope_ aSlope, LineClip_ aClip )
+	{
+		constexpr float kPi = std::numbers::pi_v<float>;
+
+		float const lengthRange[][2] = { { 2.f, 16.f }, { 16.f, 256.f }, { 256.f, 2048.f }, { 2.f, 2048.f } };
+		auto const* lengths = lengthRange[int(aLength)];
+		std::uniform_real_distribution<float> logLength( std::log( lengths[0] ), std::log( lengths[1] ) );
+
+		std::uniform_real_distribution<float> unit( 0.f, 1.f ), sign( -1.f, 1.f );
+
+		// Any of the two (or four, for diagonals) directions in each class
+		auto const random_direction = [&] () {
+			float angle = unit( aRNG ) < 0.5f ? kPi : 0.f;
+			switch( aSlope )
+			{
+				case LineSlope_::shallow: angle += sign( aRNG ) * (kPi/6.f); break;
+				case LineSlope_::steep: angle += 0.5f*kPi + sign( aRNG ) * (kPi/6.f); break;
+				case LineSlope_::diagonal: angle += (unit( aRNG ) < 0.5f ? 0.25f : 0.75f)*kPi + sign( aRNG ) * (kPi/36.f); break;
+				case LineSlope_::mix: angle = unit( aRNG ) * 2.f*kPi; break;
+			}
+
+			return Vec2f{ std::cos( angle ), std::sin( angle ) };
+		};
+
+		auto const random_clip = [&] () {
+			if( LineClip_::mix != aClip )
+				return aClip;
+
+			float const r = unit( aRNG );
+			return r < 0.80f ? LineClip_::inside : (r < 0.95f ? LineClip_::partial : LineClip_::outside);
+		};
+
+		Vec2f const origin{ aArea.xmin, aArea.ymin };
+		float const w = aArea.width, h = aArea.height;
+
+		std::vector<LineSegment> ret;
+		ret.reserve( aCount );
+
+		while( ret.size() < aCount )
+		{
+			LineClip_ const clip = random_clip();
+
+			// Draw lines until one falls into the desired class. Each class
+			// has its own placement that accepts most of the candidates;
+			// lines that are too long to fit inside are simply redrawn.
+			for( ;; )
+			{
+				Vec2f const delta = std::exp( logLength( aRNG ) ) * random_direction();
+
+				Vec2f begin;
+				if( LineClip_::inside == clip )
+				{
+					if( std::abs( delta.x ) > w || std::abs( delta.y ) > h )
+						continue;
+
+					begin.x = std::max( 0.f, -delta.x ) + unit( aRNG ) * (w - std::abs( delta.x ));
+					begin.y = std::max( 0.f, -delta.y ) + unit( aRNG ) * (h - std::abs( delta.y ));
+				}
+				else if( LineClip_::partial == clip )
+				{
+					// The line crosses the border at a random point
+					float const along = unit( aRNG ) * 2.f*(w + h);
+					Vec2f const border = along < w ? Vec2f{ along, 0.f }
+						: along < 2.f*w ? Vec2f{ along - w, h }
+						: along < 2.f*w + h ? Vec2f{ 0.f, along - 2.f*w }
+						: Vec2f{ w, along - 2.f*w - h };
+
+					begin = border - (0.05f + 0.9f * unit( aRNG )) * delta;
+				}
+				else
+				{
+					float const margin = std::max( std::abs( delta.x ), std::abs( delta.y ) ) + 64.f;
+					begin.x = -margin + unit( aRNG ) * (w + 2.f*margin);
+					begin.y = -margin + unit( aRNG ) * (h + 2.f*margin);
+				}
+
+				LineSegment const line{ origin + begin, origin + begin + delta };
+				if( classify_( aArea, line ) == clip )
+				{
+					ret.emplace_back( line );
+					break;
+				}
+			}
+		}
+
+		return ret;
+	}
+
+	// Range 0 and 1 are the surface size, range 2 to 4 select the length,
+	// slope and clip class of the lines (3 is a mix). Lines are drawn with
+	// draw_line_solid().
+	void lines_workload_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+
+		Surface surface( width, height );
+		surface.clear();
+
+		RNG rng( 3456 );
+		auto const lines = make_lines_( rng, 2048, surface.clip_area(),
+			LineLength_(aState.range(2)), LineSlope_(aState.range(3)), LineClip_(aState.range(4))
+		);
+
+		double pixels = 0.0;
+		for( auto const& line : lines )
+			pixels += line_pixels_( surface.clip_area(), line );
+
+		for( auto _ : aState )
+		{
+			for( auto const& line : lines )
+				draw_line_solid( surface, line.begin, line.end, COLOR );
+
+			benchmark::ClobberMemory();
+		}
+
+		aState.SetItemsProcessed( std::int64_t(lines.size()) * aState.iterations() );
+		aState.counters["pixels"] = benchmark::Counter( pixels * double(aState.iterations()), benchmark::Counter::kIsRate );
+	}
+
+	// Steep lines on surfaces with packed (range 2 = 0) and padded (1) rows,
+	// see SurfacePitch. With packed rows, widths with a large power of two
+	// factor map a column to few cache sets.
+	void lines_pitch_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+
+		SurfacePitch const previous = surface_pitch_preference();
+		set_surface_pitch_preference( SurfacePitch(aState.range(2)) );
+
+		Surface surface( width, height );
+		surface.clear();
+
+		set_surface_pitch_preference( previous );
+
+		RNG rng( 4567 );
+		auto const lines = make_lines_( rng, 2048, surface.clip_area(), LineLength_::mix, LineSlope_::steep, LineClip_::inside );
+
+		double pixels = 0.0;
+		for( auto const& line : lines )
+			pixels += line_pixels_( surface.clip_area(), line );
+
+		for( auto _ : aState )
+		{
+			for( auto const& line : lines )
+				draw_line_solid( surface, line.begin, line.end, COLOR );
+
+			benchmark::ClobberMemory();
+		}
+
+		aState.SetItemsProcessed( std::int64_t(lines.size()) * aState.iterations() );
+		aState.counters["pixels"] = benchmark::Counter( pixels * double(aState.iterations()), benchmark::Counter::kIsRate );
+		aState.counters["pitch"] = double(surface_pitch( surface ));
+	}
+
+	// Spaceships from make_spaceship_shape(), as drawn by main, at random
+	// positions and rotations. The positions extend past the surface by the
+	// size of the ship, so some ships are partially or entirely off-screen.
+	// Range 2 is the number of ships.
+	void lines_spaceships_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+		auto const count = std::size_t(aState.range(2));
+
+		Surface surface( width, height );
+		surface.clear();
+
+		struct Instance
+		{
+			Mat22f rotation;
+			Vec2f position;
+		};
+
+		LineStrip const ship = make_spaceship_shape();
+
+		RNG rng( 5678 );
+		std::uniform_real_distribution<float> px( -450.f, float(width) + 450.f ), py( -450.f, float(height) + 450.f );
+		std::uniform_real_distribution<float> angle( 0.f, 2.f*std::numbers::pi_v<float> );
+
+		std::vector<Instance> instances;
+		for( std::size_t i = 0; i < count; ++i )
+			instances.emplace_back( Instance{ make_rotation_2d( angle( rng ) ), Vec2f{ px( rng ), py( rng ) } } );
+
+		// Count the pixels by drawing each ship once and clearing it again.
+		// The ship fits into a box of +-450 pixels around its position.
+		std::size_t pixels = 0;
+		for( auto const& instance : instances )
+		{
+			ship.draw( surface, { 1.f, 1.f, 1.f }, instance.rotation, instance.position );
+
+			int const x0 = std::max( int(instance.position.x) - 450, 0 ), x1 = std::min( int(instance.position.x) + 450, int(width) );
+			int const y0 = std::max( int(instance.position.y) - 450, 0 ), y1 = std::min( int(instance.position.y) + 450, int(height) );
+			for( int y = y0; y < y1; ++y )
+			{
+				std::uint8_t* row = surface_row_ptr( surface, Surface::Index(y) );
+				for( int x = x0; x < x1; ++x )
+				{
+					pixels += (row[4*x+0] | row[4*x+1] | row[4*x+2]) ? 1 : 0;
+					row[4*x+0] = row[4*x+1] = row[4*x+2] = 0;
+				}
+			}
+		}
+
+		for( auto _ : aState )
+		{
+			for( auto const& instance : instances )
+				ship.draw( surface, { 1.f, 1.f, 1.f }, instance.rotation, instance.position );
+
+			benchmark::ClobberMemory();
+		}
+
+		aState.SetItemsProcessed( std::int64_t(count) * std::int64_t(ship.vertex_count() - 1) * aState.iterations() );
+		aState.counters["pixels"] = benchmark::Counter( double(pixels) * double(aState.iterations()), benchmark::Counter::kIsRate );
+	}
+
 	//
 
 
@@ -203,12 +641,74 @@ BENCHMARK( benchmark_draw_ex_line_solid ) // convert with static_cast<float>
 		->Args( { 1500, 1500 } )
 ;
 
+BENCHMARK( benchmark_draw_ex_line_symmetric ) // convert with static_cast<float>
+		->Args( { 500, 500 } )
+		->Args( { 1000, 1000 } )
+		->Args( { 1500, 1500 } )
+;
+
 BENCHMARK( benchmark_draw_ex_diagonal ) // convert with static_cast<float>
 		->Args( { 500, 500 } )
 		->Args( { 1000, 1000 } )
 		->Args( { 1500, 1500 } )
 ;	
 
+BENCHMARK( benchmark_line_kernel )
+		->ArgNames( { "kernel", "direction" } )
+		->ArgsProduct( {
+			{ 0, 1, 2, 3 }, // dda, runs, octants, default (DRAW2D_CFG_LINE_MODE)
+			{ 0, 1, 2, 3, 4, 5 } // shallow, steep, 45 degrees; up/down each
+		} )
+;
+
+BENCHMARK( benchmark_line_wide )
+		->ArgNames( { "method", "width" } )
+		->ArgsProduct( {
+			{ 0, 1 }, // draw_line_wide, draw_line_solid side by side
+			{ 2, 8, 32 }
+		} )
+;
+
+BENCHMARK( benchmark_line_aa )
+		->ArgNames( { "method", "direction" } )
+		->ArgsProduct( {
+			{ 0, 1 }, // draw_line_solid, draw_line_aa
+			{ 0, 1, 2 } // shallow, steep, 45 degrees
+		} )
+;
+
+BENCHMARK( benchmark_lines_banded )
+		->ArgNames( { "threads" } )
+		->Apply( banded_thread_counts_ )
+		->UseRealTime()
+;
+
+BENCHMARK( lines_workload_ )
+	->ArgNames( { "w", "h", "length", "slope", "clip" } )
+	// length: short, medium, long, mix (any slope, mixed clipping)
+	->ArgsProduct( { { 1920 }, { 1080 }, { 0, 1, 2, 3 }, { 3 }, { 3 } } )
+	->ArgsProduct( { { 7680 }, { 4320 }, { 0, 1, 2, 3 }, { 3 }, { 3 } } )
+	// slope: shallow, steep, diagonal (mixed lengths, inside)
+	->ArgsProduct( { { 1920 }, { 1080 }, { 3 }, { 0, 1, 2 }, { 0 } } )
+	->ArgsProduct( { { 7680 }, { 4320 }, { 3 }, { 0, 1, 2 }, { 0 } } )
+	// clip: inside, partial, outside (mixed lengths, any slope)
+	->ArgsProduct( { { 1920 }, { 1080 }, { 3 }, { 3 }, { 0, 1, 2 } } )
+	->ArgsProduct( { { 7680 }, { 4320 }, { 3 }, { 3 }, { 0, 1, 2 } } )
+;
+
+BENCHMARK( lines_pitch_ )
+	->ArgNames( { "w", "h", "pitch" } )
+	->ArgsProduct( { { 4096 }, { 2160 }, { 0, 1 } } ) // packed, padded
+	->ArgsProduct( { { 7680 }, { 4320 }, { 0, 1 } } )
+	->ArgsProduct( { { 8192 }, { 4320 }, { 0, 1 } } )
+;
+
+BENCHMARK( lines_spaceships_ )
+	->ArgNames( { "w", "h", "count" } )
+	->Args( { 1920, 1080, 64 } )
+	->Args( { 7680, 4320, 64 } )
+	->Args( { 7680, 4320, 1024 } )
+;
 
 // // these are 2 resolutions
 
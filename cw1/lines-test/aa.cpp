@@ -0,0 +1,98 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cmath>
+#include <random>
+#include <algorithm>
+
+#include "../draw2d/storage.hpp"
+#include "../draw2d/surface.hpp"
+#include "../draw2d/color.hpp"
+#include "../draw2d/line.hpp"
+
+namespace
+{
+	std::uint8_t red_( Surface const& aSurface, int aX, int aY )
+	{
+		return surface_row_ptr( aSurface, Surface::Index(aY) )[std::size_t(aX) * 4];
+	}
+}
+
+TEST_CASE( "Anti-aliased lines", "[aa]" )
+{
+	Surface surface( 320, 240 );
+
+	SECTION( "blends in linear light" )
+	{
+		// Halfway between two rows, each row receives half of the (linear)
+		// intensity. In sRGB, that is 188 and not 128.
+		surface.clear();
+		draw_line_aa( surface, { 20.f, 10.5f }, { 100.f, 10.5f }, { 255, 255, 255 } );
+
+		for( int x = 21; x < 100; ++x )
+		{
+			REQUIRE( 188 == red_( surface, x, 10 ) );
+			REQUIRE( 188 == red_( surface, x, 11 ) );
+			REQUIRE( 0 == red_( surface, x, 9 ) );
+			REQUIRE( 0 == red_( surface, x, 12 ) );
+		}
+
+		// On a pixel center, the line covers a single row completely, and
+		// the other row is unchanged.
+		surface.fill( { 50, 100, 150 } );
+		draw_line_aa( surface, { 20.f, 30.f }, { 100.f, 30.f }, { 255, 0, 0 } );
+
+		for( int x = 21; x < 100; ++x )
+		{
+			REQUIRE( 255 == red_( surface, x, 30 ) );
+			REQUIRE( 50 == red_( surface, x, 31 ) );
+		}
+	}
+
+	SECTION( "intensity sums to one" )
+	{
+		// Away from the endpoints, the two pixels of each step share the
+		// full intensity. Lines go in all directions.
+		std::minstd_rand rng( 42 );
+		std::uniform_real_distribution<float> pos( 10.f, 230.f );
+
+		SrgbTables const& tables = srgb_tables();
+
+		for( int i = 0; i < 200; ++i )
+		{
+			Vec2f const begin{ pos( rng ), pos( rng ) }, end{ pos( rng ), pos( rng ) };
+			bool const steep = std::fabs( end.y - begin.y ) > std::fabs( end.x - begin.x );
+
+			surface.clear();
+			draw_line_aa( surface, begin, end, { 255, 255, 255 } );
+
+			float const lo = std::min( steep ? begin.y : begin.x, steep ? end.y : end.x );
+			float const hi = std::max( steep ? begin.y : begin.x, steep ? end.y : end.x );
+
+			for( int major = int(std::ceil( lo )) + 1; major <= int(std::floor( hi )) - 1; ++major )
+			{
+				float sum = 0.f;
+				for( int minor = 0; minor < 240; ++minor )
+					sum += tables.decode[steep ? red_( surface, minor, major ) : red_( surface, major, minor )];
+
+				REQUIRE( sum == Catch::Approx( 1.f ).margin( 0.01 ) );
+			}
+		}
+	}
+
+	SECTION( "clipped" )
+	{
+		// Lines along and beyond the edges of the surface only touch pixels
+		// on the surface (checked by the sanitizers in debug builds), and
+		// keep their partially covered pixels on the edge.
+		surface.clear();
+		draw_line_aa( surface, { -50.f, -0.5f }, { 400.f, -0.5f }, { 255, 255, 255 } );
+		draw_line_aa( surface, { 319.5f, -50.f }, { 319.5f, 300.f }, { 255, 255, 255 } );
+		draw_line_aa( surface, { -1000.f, -900.f }, { 1000.f, 1100.f }, { 255, 255, 255 } );
+		draw_line_aa( surface, { -10.f, 500.f }, { 400.f, 500.f }, { 255, 255, 255 } );
+
+		REQUIRE( 188 == red_( surface, 100, 0 ) );
+		REQUIRE( 188 == red_( surface, 319, 100 ) );
+		REQUIRE( 0 == red_( surface, 100, 1 ) );
+		REQUIRE( 0 == red_( surface, 318, 100 ) );
+	}
+}
@@ -0,0 +1,110 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <algorithm>
+
+#include "../draw2d/storage.hpp"
+#include "../draw2d/surface.hpp"
+#include "../draw2d/draw.hpp"
+#include "../draw2d/line.hpp"
+
+namespace
+{
+	bool same_pixels_( Surface const& aA, Surface const& aB )
+	{
+		auto const bytes = surface_pitch( aA ) * aA.get_height();
+		return std::equal( aA.get_surface_ptr(), aA.get_surface_ptr() + bytes, aB.get_surface_ptr() );
+	}
+
+	// The generic path that draw_line_axis_aligned() replaces
+	void draw_generic_( Surface& aSurface, Rect2F const& aClipArea, Vec2f aBegin, Vec2f aEnd )
+	{
+		if( !clip_line( aClipArea, aBegin, aEnd ) || !clip_line( aSurface.clip_area(), aBegin, aEnd ) )
+			return;
+
+		LineSetup setup;
+		if( setup_line( setup, aSurface, aBegin, aEnd ) )
+			rasterize_line_dda( aSurface, setup, 0xffffffu );
+	}
+}
+
+TEST_CASE( "Axis-aligned lines", "[axis]" )
+{
+	Surface reference( 320, 240 ), other( 320, 240 );
+
+	SECTION( "same as generic path" )
+	{
+		// Horizontal, vertical and single-pixel lines, mostly partially
+		// off-screen, clipped against the surface or against a rectangle
+		// that sticks out of it.
+		std::minstd_rand rng( 42 );
+		std::uniform_real_distribution<float> pos( -80.f, 400.f );
+
+		Rect2F const areas[] = { reference.clip_area(), Rect2F{ 50.5f, -20.f, 300.f, 100.25f } };
+
+		for( int i = 0; i < 3000; ++i )
+		{
+			Vec2f begin{ pos( rng ), pos( rng ) };
+			Vec2f end{ pos( rng ), pos( rng ) };
+
+			switch( i % 3 )
+			{
+				case 0: end.y = begin.y; break;
+				case 1: end.x = begin.x; break;
+				case 2: end = begin; break;
+			}
+
+			Rect2F const& area = areas[(i/3) % 2];
+
+			reference.clear();
+			draw_generic_( reference, area, begin, end );
+
+			other.clear();
+			REQUIRE( draw_line_axis_aligned( other, area, begin, end, 0xffffffu ) );
+			REQUIRE( same_pixels_( reference, other ) );
+		}
+	}
+
+	SECTION( "other lines" )
+	{
+		REQUIRE( !draw_line_axis_aligned( other, other.clip_area(), { 10.f, 10.f }, { 20.f, 11.f }, 0xffffffu ) );
+	}
+}
+
+TEST_CASE( "Rectangle outlines", "[axis]" )
+{
+	// The outline is the solid rectangle minus the rectangle that is one
+	// pixel smaller on each side. (draw_rectangle_solid() orders the corners,
+	// so the inner rectangle is only drawn if it does not flip.)
+	Surface reference( 320, 240 ), outline( 320, 240 );
+
+	std::minstd_rand rng( 43 );
+	std::uniform_real_distribution<float> pos( -50.f, 370.f );
+
+	for( int i = 0; i < 500; ++i )
+	{
+		Vec2f const a{ pos( rng ), pos( rng ) };
+		Vec2f const b{ pos( rng ), pos( rng ) };
+		Vec2f const lo{ std::min( a.x, b.x ), std::min( a.y, b.y ) };
+		Vec2f const hi{ std::max( a.x, b.x ), std::max( a.y, b.y ) };
+
+		Surface inner( 320, 240 );
+		inner.clear();
+		Vec2f const innerLo = lo + Vec2f{ 1.f, 1.f }, innerHi = hi - Vec2f{ 1.f, 1.f };
+		if( innerLo.x < innerHi.x && innerLo.y < innerHi.y )
+			draw_rectangle_solid( inner, innerLo, innerHi, { 255, 255, 255 } );
+
+		reference.clear();
+		draw_rectangle_solid( reference, lo, hi, { 255, 255, 255 } );
+
+		auto* ref = surface_row_ptr( reference, 0 );
+		auto const* in = inner.get_surface_ptr();
+		for( std::size_t j = 0; j < surface_pitch( reference ) * 240; ++j )
+			ref[j] = std::uint8_t(ref[j] & ~in[j]);
+
+		outline.clear();
+		draw_rectangle_outline( outline, lo, hi, { 255, 255, 255 } );
+
+		REQUIRE( same_pixels_( reference, outline ) );
+	}
+}
@@ -0,0 +1,121 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <limits>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "../draw2d/storage.hpp"
+#include "../draw2d/surface.hpp"
+#include "../draw2d/draw.hpp"
+#include "../draw2d/line.hpp"
+
+namespace
+{
+	bool same_pixels_( Surface const& aA, Surface const& aB )
+	{
+		auto const bytes = surface_pitch( aA ) * aA.get_height();
+		return std::equal( aA.get_surface_ptr(), aA.get_surface_ptr() + bytes, aB.get_surface_ptr() );
+	}
+}
+
+TEST_CASE( "Batched lines", "[batch]" )
+{
+	Surface reference( 320, 240 ), batch( 320, 240 );
+
+	SECTION( "unclipped" )
+	{
+		// Segments that are entirely inside or entirely off to one side are
+		// never clipped, and must match draw_line_solid() exactly. The count
+		// is not a multiple of eight, so the scalar tail is exercised too.
+		std::minstd_rand rng( 42 );
+		std::uniform_real_distribution<float> x( 0.f, 319.f ), y( 0.f, 239.f );
+
+		std::vector<LineSegment> segments;
+		for( int i = 0; i < 403; ++i )
+		{
+			Vec2f const begin{ x( rng ), y( rng ) }, end{ x( rng ), y( rng ) };
+			switch( i % 3 )
+			{
+				case 0: segments.emplace_back( begin, end ); break;
+				case 1: segments.emplace_back( begin - Vec2f{ 400.f, 0.f }, end - Vec2f{ 400.f, 0.f } ); break;
+				case 2: segments.emplace_back( begin + Vec2f{ 0.f, 300.f }, end + Vec2f{ 0.f, 300.f } ); break;
+			}
+		}
+
+		reference.clear();
+		for( auto const& segment : segments )
+			draw_line_solid( reference, segment.begin, segment.end, { 255, 255, 255 } );
+
+		batch.clear();
+		draw_lines_solid( batch, segments, { 255, 255, 255 } );
+
+		REQUIRE( same_pixels_( reference, batch ) );
+	}
+
+	SECTION( "clipped" )
+	{
+		// Clipped segments may differ from draw_line_solid() where the two
+		// clips round differently. This should be rare.
+		std::minstd_rand rng( 43 );
+		std::uniform_real_distribution<float> pos( -200.f, 520.f );
+
+		int differ = 0;
+		for( int i = 0; i < 1000; ++i )
+		{
+			LineSegment const segment{ { pos( rng ), pos( rng ) }, { pos( rng ), pos( rng ) } };
+
+			reference.clear();
+			draw_line_solid( reference, segment.begin, segment.end, { 255, 255, 255 } );
+
+			batch.clear();
+			draw_lines_solid( batch, { &segment, 1 }, { 255, 255, 255 } );
+
+			if( !same_pixels_( reference, batch ) )
+				++differ;
+		}
+
+		REQUIRE( differ <= 10 );
+	}
+
+	SECTION( "bands" )
+	{
+		// Each band only draws its own rows of the lines, which must add up
+		// to exactly the pixels of draw_lines_solid(). 240 rows do not split
+		// evenly into 7 bands.
+		std::minstd_rand rng( 44 );
+		std::uniform_real_distribution<float> pos( -100.f, 420.f );
+
+		std::vector<LineSegment> segments;
+		for( int i = 0; i < 500; ++i )
+			segments.emplace_back( Vec2f{ pos( rng ), pos( rng ) }, Vec2f{ pos( rng ), pos( rng ) } );
+
+		reference.clear();
+		draw_lines_solid( reference, segments, { 255, 255, 255 } );
+
+		for( unsigned bands : { 2u, 3u, 7u, 1000u } )
+		{
+			batch.clear();
+			draw_lines_solid_banded( batch, segments, { 255, 255, 255 }, bands );
+			REQUIRE( same_pixels_( reference, batch ) );
+		}
+	}
+
+	SECTION( "non-finite" )
+	{
+		// Not drawn at all. (Nine segments, so that both the AVX2 path and the
+		// scalar tail see them.)
+		float const nan = std::numeric_limits<float>::quiet_NaN();
+		float const inf = std::numeric_limits<float>::infinity();
+
+		std::vector<LineSegment> segments;
+		for( int i = 0; i < 9; ++i )
+			segments.emplace_back( Vec2f{ 10.f, 10.f }, i % 2 ? Vec2f{ nan, 20.f } : Vec2f{ 20.f, inf } );
+
+		batch.clear();
+		draw_lines_solid( batch, segments, { 255, 255, 255 } );
+
+		reference.clear();
+		REQUIRE( same_pixels_( reference, batch ) );
+	}
+}
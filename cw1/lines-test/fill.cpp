@@ -0,0 +1,59 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <vector>
+#include <algorithm>
+
+#include <cstring>
+
+#include "../draw2d/fill.hpp"
+#include "../draw2d/storage.hpp"
+#include "../draw2d/surface.hpp"
+
+TEST_CASE( "Surface fill and clear", "[fill]" )
+{
+	SECTION( "block boundaries" )
+	{
+		// Blocks of different lengths and alignments. Only the pixels in the
+		// block change. The large blocks are above the streaming threshold.
+		std::size_t const large = DRAW2D_CFG_FILL_STREAM_BYTES/4 + 37;
+		std::vector<std::uint8_t> buffer( 4*(large + 64), 0xee );
+
+		std::uint32_t const rgbx = pack_rgbx( { 10, 20, 30 } );
+
+		for( std::size_t count : { std::size_t(0), std::size_t(1), std::size_t(7), std::size_t(45), large } )
+		{
+			for( std::size_t offset : { 0, 1, 5 } )
+			{
+				std::fill( buffer.begin(), buffer.end(), std::uint8_t(0xee) );
+				fill_pixels( buffer.data() + 4*offset, count, rgbx );
+
+				std::size_t wrong = 0;
+				for( std::size_t i = 0; i < buffer.size()/4; ++i )
+				{
+					std::uint32_t pixel;
+					std::memcpy( &pixel, buffer.data() + 4*i, sizeof(pixel) );
+
+					bool const inside = i >= offset && i < offset + count;
+					wrong += pixel != (inside ? rgbx : 0xeeeeeeeeu);
+				}
+
+				REQUIRE( 0 == wrong );
+			}
+		}
+	}
+
+	SECTION( "large surface" )
+	{
+		// 2560x1700 pixels are 17 MB, so the surface is streamed
+		Surface surface( 2560, 1700 );
+
+		surface.fill( { 1, 2, 3 } );
+		std::uint8_t const* ptr = surface.get_surface_ptr();
+		REQUIRE( ptr[0] == 1 );
+		REQUIRE( surface_row_ptr( surface, 1699 )[4*2559 + 2] == 3 );
+		REQUIRE( surface_row_ptr( surface, 1699 )[4*2559 + 3] == 0 );
+
+		surface.clear();
+		REQUIRE( std::all_of( ptr, ptr + surface_pitch( surface ) * 1700, [] (std::uint8_t aX) { return 0 == aX; } ) );
+	}
+}
@@ -4,13 +4,14 @@
 
 #include <cassert>
 
+#include "../draw2d/storage.hpp"
 #include "../draw2d/surface.hpp"
 
 std::size_t max_row_pixel_count( Surface const& aSurface )
 {
 	std::size_t res = 0;
 
-	auto const stride = aSurface.get_width() << 2;
+	auto const stride = surface_pitch( aSurface ); // rows may be padded
 	for( std::uint32_t y = 0; y < aSurface.get_height(); ++y )
 	{
 		std::size_t inRow = 0;
@@ -39,7 +40,7 @@ std::size_t max_col_pixel_count( Surface const& aSurface )
 {
 	std::size_t res = 0;
 
-	auto const stride = aSurface.get_width() << 2;
+	auto const stride = surface_pitch( aSurface ); // rows may be padded
 	for( std::uint32_t x = 0; x < aSurface.get_width(); ++x )
 	{
 		std::size_t inCol = 0;
@@ -74,7 +75,7 @@ std::array<std::size_t,9> count_pixel_neighbours( Surface const& aSurface )
 	// diagonals (4).
 	static_assert( sizeof(kNeighbourOffsets)/sizeof(kNeighbourOffsets[0]) == 8 );
 
-	auto const stride = aSurface.get_width() << 2;
+	auto const stride = surface_pitch( aSurface ); // rows may be padded
 	for( std::uint32_t yp = 0; yp < aSurface.get_height(); ++yp )
 	{
 		for( std::uint32_t xp = 0; xp < aSurface.get_width(); ++xp )
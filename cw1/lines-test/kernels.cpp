@@ -0,0 +1,146 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#include "../draw2d/storage.hpp"
+#include "../draw2d/surface.hpp"
+#include "../draw2d/draw.hpp"
+#include "../draw2d/line.hpp"
+
+namespace
+{
+	bool same_pixels_( Surface const& aA, Surface const& aB )
+	{
+		auto const bytes = surface_pitch( aA ) * aA.get_height();
+		return std::equal( aA.get_surface_ptr(), aA.get_surface_ptr() + bytes, aB.get_surface_ptr() );
+	}
+}
+
+TEST_CASE( "Line kernels agree", "[kernels]" )
+{
+	// The different kernels in line.hpp must produce identical results. Lines
+	// are random and mostly partially off-screen; every few lines is made
+	// horizontal, vertical or short, or starts on the edge of the surface,
+	// where the clipped endpoints round to pixels outside of it.
+	std::minstd_rand rng( 42 );
+	std::uniform_real_distribution<float> pos( -80.f, 400.f );
+
+	Surface reference( 320, 240 ), other( 320, 240 );
+
+	for( int i = 0; i < 2000; ++i )
+	{
+		Vec2f begin{ pos( rng ), pos( rng ) };
+		Vec2f end{ pos( rng ), pos( rng ) };
+
+		switch( i % 6 )
+		{
+			case 1: end.y = begin.y; break;
+			case 2: end.x = begin.x; break;
+			case 3: end = begin + Vec2f{ 1.5f, -0.7f }; break;
+			case 4: begin.y = 240.f; break;
+			case 5: begin.x = 320.f; break;
+		}
+
+		if( !clip_line( reference.clip_area(), begin, end ) )
+			continue;
+
+		LineSetup setup;
+		if( !setup_line( setup, reference, begin, end ) )
+			continue;
+
+		reference.clear();
+		rasterize_line_dda( reference, setup, 0xffffffu );
+
+		other.clear();
+		rasterize_line_runs( other, setup, 0xffffffu );
+		REQUIRE( same_pixels_( reference, other ) );
+
+		other.clear();
+		rasterize_line_octants( other, setup, 0xffffffu );
+		REQUIRE( same_pixels_( reference, other ) );
+	}
+}
+
+TEST_CASE( "Symmetric octant kernel", "[kernels]" )
+{
+	// draw_line_octant_symmetric() walks from both ends, and must set the
+	// same pixels as draw_line_octant() in each octant. Walks start in the
+	// middle, and are short enough to stay inside of the surface. Odd and
+	// even counts meet in a pixel or between two.
+	std::minstd_rand rng( 43 );
+	std::uniform_int_distribution<int> count( 1, 100 ), den( 1, 300 );
+
+	Surface reference( 320, 240 ), other( 320, 240 );
+
+	for( int i = 0; i < 2000; ++i )
+	{
+		LineWalk walk;
+		walk.pixel = nullptr;
+		walk.rowStride = std::ptrdiff_t(reference.get_width()) * 4;
+		walk.count = count( rng );
+
+		walk.xMajor = i & 1;
+		walk.majorDir = i & 2 ? 1 : -1;
+		walk.minorDir = i & 4 ? 1 : -1;
+
+		walk.den = den( rng );
+		walk.step = std::uniform_int_distribution<std::int64_t>( 0, walk.den )( rng );
+		walk.rem = std::uniform_int_distribution<std::int64_t>( 0, walk.den-1 )( rng );
+
+		reference.clear();
+		walk.pixel = surface_row_ptr( reference, 120 ) + 160*4;
+		draw_line_octant( walk, 0xffffffu );
+
+		other.clear();
+		walk.pixel = surface_row_ptr( other, 120 ) + 160*4;
+		draw_line_octant_symmetric( walk, 0xffffffu );
+
+		REQUIRE( same_pixels_( reference, other ) );
+	}
+}
+
+TEST_CASE( "Diagonal line setup", "[kernels]" )
+{
+	// The float extents of these lines are equal (or differ in the last
+	// bit), but the endpoints round to fixed point such that the extents
+	// differ by a subpixel. The major axis must be the longer one in fixed
+	// point, or the minor coordinate would change by more than one per step.
+	Surface reference( 320, 240 ), other( 320, 240 );
+
+	auto const check = [&] (Vec2f aBegin, Vec2f aEnd) {
+		LineSetup setup;
+		REQUIRE( setup_line( setup, reference, aBegin, aEnd ) );
+		REQUIRE( std::abs( setup.step ) <= setup.den );
+
+		reference.clear();
+		rasterize_line_dda( reference, setup, 0xffffffu );
+
+		other.clear();
+		rasterize_line_octants( other, setup, 0xffffffu );
+		REQUIRE( same_pixels_( reference, other ) );
+	};
+
+	SECTION( "uneven snapping" )
+	{
+		check( { 0x1.4d07bcp+4f, 0x1.f67b74p+4f }, { 0x1.4668e2p+5f, 0x1.9b22bep+5f } );
+		check( { 0x1.4668e2p+5f, 0x1.9b22bep+5f }, { 0x1.4d07bcp+4f, 0x1.f67b74p+4f } );
+		check( { 0x1.47020ep+2f, 0x1.4593acp+5f }, { 0x1.1e5c3cp+5f, 0x1.1d87d4p+6f } );
+	}
+
+	SECTION( "random" )
+	{
+		std::minstd_rand rng( 44 );
+		std::uniform_real_distribution<float> pos( 40.f, 200.f ), length( 1.f, 39.f );
+
+		for( int i = 0; i < 20000; ++i )
+		{
+			Vec2f const begin{ pos( rng ), pos( rng ) };
+			float const t = length( rng );
+			check( begin, begin + Vec2f{ i & 1 ? t : -t, i & 2 ? t : -t } );
+		}
+	}
+}
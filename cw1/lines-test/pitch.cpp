@@ -0,0 +1,147 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <vector>
+#include <functional>
+
+#include "../draw2d/draw.hpp"
+#include "../draw2d/line.hpp"
+#include "../draw2d/storage.hpp"
+#include "../draw2d/draw-ex.hpp"
+#include "../draw2d/surface-ex.hpp"
+
+namespace
+{
+	SurfaceEx make_surface_( SurfacePitch aPitch )
+	{
+		SurfacePitch const previous = surface_pitch_preference();
+		set_surface_pitch_preference( aPitch );
+
+		SurfaceEx ret( 256, 200 );
+		set_surface_pitch_preference( previous );
+
+		ret.clear();
+		return ret;
+	}
+
+	// Number of image pixels that differ, and number of padding bytes that
+	// are no longer zero
+	void compare_( SurfaceEx& aPacked, SurfaceEx& aPadded, int& aDifferent, int& aPadding )
+	{
+		aDifferent = aPadding = 0;
+		for( Surface::Index y = 0; y < 200; ++y )
+		{
+			std::uint8_t const* packed = surface_row_ptr( aPacked, y );
+			std::uint8_t const* padded = surface_row_ptr( aPadded, y );
+
+			for( std::size_t i = 0; i < 256*4; ++i )
+				aDifferent += packed[i] != padded[i];
+
+			for( std::size_t i = 256*4; i < surface_pitch( aPadded ); ++i )
+				aPadding += 0 != padded[i];
+		}
+	}
+}
+
+TEST_CASE( "Padded rows", "[pitch]" )
+{
+	// 256 pixels are 16 cache lines; padded rows use 17
+	SurfaceEx packed = make_surface_( SurfacePitch::packed );
+	SurfaceEx padded = make_surface_( SurfacePitch::padded );
+
+	REQUIRE( 256*4 == surface_pitch( packed ) );
+	REQUIRE( 17*64 == surface_pitch( padded ) );
+	REQUIRE( 200*17*16 + 5 == padded.get_linear_index( 5, 200 ) );
+
+	// Each drawing function produces the same image with either pitch, and
+	// leaves the padding alone.
+	std::minstd_rand rng( 42 );
+	std::uniform_real_distribution<float> pos( -40.f, 300.f );
+
+	std::vector<LineSegment> segments( 64 );
+	for( auto& segment : segments )
+		segment = LineSegment{ { pos( rng ), pos( rng ) }, { pos( rng ), pos( rng ) } };
+
+	using Draw = std::function<void (SurfaceEx&, LineSegment const&)>;
+	std::pair<char const*, Draw> const draws[] = {
+		{ "line", [] (SurfaceEx& aS, LineSegment const& aL) { draw_line_solid( aS, aL.begin, aL.end, { 255, 255, 255 } ); } },
+		{ "dda", [] (SurfaceEx& aS, LineSegment const& aL) {
+			LineSetup setup;
+			Vec2f begin = aL.begin, end = aL.end;
+			if( clip_line( aS.clip_area(), begin, end ) && setup_line( setup, aS, begin, end ) )
+				rasterize_line_dda( aS, setup, 0xffffffu );
+		} },
+		{ "octants", [] (SurfaceEx& aS, LineSegment const& aL) {
+			LineSetup setup;
+			Vec2f begin = aL.begin, end = aL.end;
+			if( clip_line( aS.clip_area(), begin, end ) && setup_line( setup, aS, begin, end ) )
+				rasterize_line_octants( aS, setup, 0xffffffu );
+		} },
+		{ "ex line", [] (SurfaceEx& aS, LineSegment const& aL) { draw_ex_line_solid( aS, aL.begin, aL.end, { 255, 255, 255 } ); } },
+		{ "ex symmetric", [] (SurfaceEx& aS, LineSegment const& aL) { draw_ex_line_solid_symmetric( aS, aL.begin, aL.end, { 255, 255, 255 } ); } },
+		{ "aa", [] (SurfaceEx& aS, LineSegment const& aL) { draw_line_aa( aS, aL.begin, aL.end, { 255, 255, 255 } ); } },
+		{ "wide", [] (SurfaceEx& aS, LineSegment const& aL) { draw_line_wide( aS, aL.begin, aL.end, 7.f, { 255, 255, 255 } ); } },
+		{ "outline", [] (SurfaceEx& aS, LineSegment const& aL) { draw_rectangle_outline( aS, aL.begin, aL.end, { 255, 255, 255 } ); } },
+		{ "triangle", [] (SurfaceEx& aS, LineSegment const& aL) {
+			draw_triangle_interp( aS, aL.begin, aL.end, 0.5f*(aL.begin + aL.end) + Vec2f{ 30.f, -20.f }, { 1.f, 0.f, 0.f }, { 0.f, 1.f, 0.f }, { 0.f, 0.f, 1.f } );
+		} },
+	};
+
+	for( auto const& [name, draw] : draws )
+	{
+		INFO( name );
+
+		packed.clear();
+		padded.clear();
+		for( auto const& segment : segments )
+		{
+			draw( packed, segment );
+			draw( padded, segment );
+		}
+
+		int different, padding;
+		compare_( packed, padded, different, padding );
+		REQUIRE( 0 == different );
+		REQUIRE( 0 == padding );
+	}
+
+	// Batches, on multiple threads
+	packed.clear();
+	padded.clear();
+	draw_lines_solid_banded( packed, segments, { 255, 255, 255 }, 3 );
+	draw_lines_solid_banded( padded, segments, { 255, 255, 255 }, 3 );
+
+	int different, padding;
+	compare_( packed, padded, different, padding );
+	REQUIRE( 0 == different );
+	REQUIRE( 0 == padding );
+
+	// Diagonal
+	packed.clear();
+	padded.clear();
+	draw_ex_diagonal( packed, { 20.f, 10.f }, 150.f, { 255, 255, 255 } );
+	draw_ex_diagonal( padded, { 20.f, 10.f }, 150.f, { 255, 255, 255 } );
+
+	compare_( packed, padded, different, padding );
+	REQUIRE( 0 == different );
+	REQUIRE( 0 == padding );
+}
+
+TEST_CASE( "Automatic row pitch", "[pitch]" )
+{
+	// Only widths whose packed pitch is a multiple of 4 kB are padded
+	SurfacePitch const previous = surface_pitch_preference();
+	set_surface_pitch_preference( SurfacePitch::automatic );
+
+	Surface const narrow( 256, 4 );
+	Surface const full( 1920, 4 );
+	Surface const aliased( 1024, 4 );
+	Surface const wide( 4096, 4 );
+
+	set_surface_pitch_preference( previous );
+
+	REQUIRE( 256*4 == surface_pitch( narrow ) );
+	REQUIRE( 1920*4 == surface_pitch( full ) );
+	REQUIRE( 65*64 == surface_pitch( aliased ) );
+	REQUIRE( 257*64 == surface_pitch( wide ) );
+}
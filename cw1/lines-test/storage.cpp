@@ -0,0 +1,41 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <utility>
+
+#include <cstdint>
+
+#include "../draw2d/storage.hpp"
+#include "../draw2d/surface.hpp"
+
+TEST_CASE( "Surface storage", "[storage]" )
+{
+	SurfaceStorage const previous = surface_storage_preference();
+
+	// Every preference gives aligned pixels, for small and large surfaces,
+	// falling back where necessary. Surfaces below the huge page threshold
+	// always use regular pages.
+	for( auto const preference : { SurfaceStorage::aligned, SurfaceStorage::hugePages, SurfaceStorage::hugeTLB } )
+	{
+		set_surface_storage_preference( preference );
+
+		Surface small( 64, 64 ), large( 2048, 1024 );
+		set_surface_storage_preference( previous );
+
+		for( Surface* surface : { &small, &large } )
+		{
+			auto const address = reinterpret_cast<std::uintptr_t>(surface->get_surface_ptr());
+			REQUIRE( 0 == address % kPixelAlignment );
+
+			surface->fill( { 1, 2, 3 } );
+			REQUIRE( 3 == surface_row_ptr( *surface, 63 )[4*63 + 2] );
+		}
+
+		REQUIRE( SurfaceStorage::aligned == surface_storage( small ) );
+		REQUIRE( surface_storage( large ) <= preference );
+
+		// Storage moves with the pixels
+		SurfaceStorage const storage = surface_storage( large );
+		Surface moved( std::move( large ) );
+		REQUIRE( storage == surface_storage( moved ) );
+	}
+}
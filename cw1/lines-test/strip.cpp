@@ -0,0 +1,103 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "../draw2d/shape.hpp"
+#include "../draw2d/storage.hpp"
+#include "../draw2d/surface.hpp"
+#include "../draw2d/draw.hpp"
+
+namespace
+{
+	bool same_pixels_( Surface const& aA, Surface const& aB )
+	{
+		auto const bytes = surface_pitch( aA ) * aA.get_height();
+		return std::equal( aA.get_surface_ptr(), aA.get_surface_ptr() + bytes, aB.get_surface_ptr() );
+	}
+
+	void draw_segments_( Surface& aSurface, std::vector<Vec2f> const& aVertices, ColorF const& aColor, Mat22f const& aRotation, Vec2f aTranslation )
+	{
+		ColorU8_sRGB const color = linear_to_srgb( aColor );
+		for( std::size_t i = 1; i < aVertices.size(); ++i )
+		{
+			Vec2f const begin = aRotation * aVertices[i-1] + aTranslation;
+			Vec2f const end = aRotation * aVertices[i] + aTranslation;
+			draw_line_solid( aSurface, begin, end, color );
+		}
+	}
+
+	// Random walk with steps of up to aStep pixels
+	std::vector<Vec2f> random_walk_( std::size_t aCount, float aStep, unsigned aSeed )
+	{
+		std::minstd_rand rng( aSeed );
+		std::uniform_real_distribution<float> step( -aStep, aStep );
+
+		std::vector<Vec2f> ret( aCount );
+		for( std::size_t i = 1; i < aCount; ++i )
+			ret[i] = ret[i-1] + Vec2f{ step( rng ), step( rng ) };
+		return ret;
+	}
+}
+
+TEST_CASE( "Line strips", "[strip]" )
+{
+	// LineStrip::draw() takes different paths depending on whether (parts
+	// of) the strip are on-screen. Either way, the result must match drawing
+	// each segment with draw_line_solid().
+	Surface reference( 320, 240 ), strip( 320, 240 );
+	ColorF const color{ 1.f, 1.f, 1.f };
+
+	auto const check = [&] (std::vector<Vec2f> const& aVertices, Mat22f const& aRotation, Vec2f aTranslation) {
+		reference.clear();
+		draw_segments_( reference, aVertices, color, aRotation, aTranslation );
+
+		strip.clear();
+		LineStrip( aVertices.size(), aVertices.data() ).draw( strip, color, aRotation, aTranslation );
+
+		REQUIRE( same_pixels_( reference, strip ) );
+	};
+
+	Mat22f const identity{ 1.f, 0.f, 0.f, 1.f };
+	Mat22f const rotation = make_rotation_2d( 0.6f );
+
+	SECTION( "on-screen" )
+	{
+		auto const verts = random_walk_( 200, 4.f, 42 );
+		check( verts, identity, { 160.f, 120.f } );
+		check( verts, rotation, { 160.f, 120.f } );
+	}
+
+	SECTION( "partially off-screen" )
+	{
+		auto const verts = random_walk_( 2000, 20.f, 43 );
+		check( verts, identity, { 160.f, 120.f } );
+		check( verts, rotation, { 300.f, 20.f } );
+	}
+
+	SECTION( "long" )
+	{
+		// Wanders on and off the surface. Most chunks are either entirely
+		// on-screen or entirely off-screen.
+		std::vector<Vec2f> verts( 100000 );
+		for( std::size_t i = 0; i < verts.size(); ++i )
+		{
+			float const t = float(i) * 1e-3f;
+			verts[i] = Vec2f{ 250.f * std::sin( 0.7f * t ), 200.f * std::cos( 1.3f * t ) };
+		}
+
+		check( verts, identity, { 160.f, 120.f } );
+		check( verts, rotation, { 100.f, 100.f } );
+	}
+
+	SECTION( "degenerate" )
+	{
+		// Repeated vertices produce zero-length segments
+		std::vector<Vec2f> const verts{ { 10.f, 10.f }, { 10.f, 10.f }, { 20.f, 15.f }, { 20.f, 15.f }, { 20.f, 15.f }, { 5.f, 30.f } };
+		check( verts, identity, { 100.f, 100.f } );
+
+		check( { { 10.f, 10.f } }, identity, { 100.f, 100.f } );
+	}
+}
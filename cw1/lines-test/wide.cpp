@@ -0,0 +1,113 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <algorithm>
+
+#include "../draw2d/storage.hpp"
+#include "../draw2d/surface.hpp"
+#include "../draw2d/draw.hpp"
+#include "../draw2d/line.hpp"
+
+namespace
+{
+	bool is_set_( Surface const& aSurface, int aX, int aY )
+	{
+		auto const* pixel = surface_row_ptr( aSurface, Surface::Index(aY) ) + std::size_t(aX) * 4;
+		return pixel[0] || pixel[1] || pixel[2];
+	}
+
+	// Signed distance of p from the boundary of the line's rectangle
+	// (positive inside), in double
+	double inside_distance_( Vec2f aBegin, Vec2f aEnd, double aWidth, double aX, double aY )
+	{
+		double const dx = double(aEnd.x) - aBegin.x, dy = double(aEnd.y) - aBegin.y;
+		double const length = std::sqrt( dx*dx + dy*dy );
+
+		double const along = ((aX - aBegin.x) * dx + (aY - aBegin.y) * dy) / length;
+		double const across = ((aX - aBegin.x) * -dy + (aY - aBegin.y) * dx) / length;
+
+		return std::min( { along, length - along, 0.5*aWidth - std::abs( across ) } );
+	}
+}
+
+TEST_CASE( "Wide lines", "[wide]" )
+{
+	Surface surface( 320, 240 );
+
+	SECTION( "covers the rectangle" )
+	{
+		// Pixels whose centers are clearly inside (outside) of the rectangle
+		// must (must not) be set. Centers close to an edge depend on the
+		// snapping and the fill rule.
+		std::minstd_rand rng( 42 );
+		std::uniform_real_distribution<float> pos( -60.f, 380.f ), width( 0.5f, 30.f );
+
+		for( int i = 0; i < 300; ++i )
+		{
+			Vec2f const begin{ pos( rng ), pos( rng ) }, end{ pos( rng ), pos( rng ) };
+			float const w = width( rng );
+
+			surface.clear();
+			draw_line_wide( surface, begin, end, w, { 255, 255, 255 } );
+
+			int wrong = 0;
+			for( int y = 0; y < 240; ++y )
+			{
+				for( int x = 0; x < 320; ++x )
+				{
+					double const d = inside_distance_( begin, end, w, x + 0.5, y + 0.5 );
+					if( std::abs( d ) > 0.01 && is_set_( surface, x, y ) != (d > 0.) )
+						++wrong;
+				}
+			}
+
+			REQUIRE( 0 == wrong );
+		}
+	}
+
+	SECTION( "polyline joints" )
+	{
+		// Collinear consecutive segments share the edge at their common
+		// endpoint. With the fill rule, no pixel is covered by both.
+		Surface second( 320, 240 );
+
+		surface.clear();
+		draw_line_wide( surface, { 20.f, 30.f }, { 160.f, 120.f }, 12.f, { 255, 255, 255 } );
+
+		second.clear();
+		draw_line_wide( second, { 160.f, 120.f }, { 300.f, 210.f }, 12.f, { 255, 255, 255 } );
+
+		int set = 0, shared = 0;
+		for( int y = 0; y < 240; ++y )
+		{
+			for( int x = 0; x < 320; ++x )
+			{
+				set += is_set_( second, x, y );
+				shared += is_set_( surface, x, y ) && is_set_( second, x, y );
+			}
+		}
+
+		REQUIRE( set > 0 );
+		REQUIRE( 0 == shared );
+	}
+
+	SECTION( "degenerate" )
+	{
+		float const nan = std::numeric_limits<float>::quiet_NaN();
+
+		surface.clear();
+		draw_line_wide( surface, { 10.f, 10.f }, { 10.f, 10.f }, 5.f, { 255, 255, 255 } );
+		draw_line_wide( surface, { 10.f, 10.f }, { 50.f, 10.f }, 0.f, { 255, 255, 255 } );
+		draw_line_wide( surface, { 10.f, 10.f }, { 50.f, 10.f }, nan, { 255, 255, 255 } );
+		draw_line_wide( surface, { 10.f, nan }, { 50.f, 10.f }, 5.f, { 255, 255, 255 } );
+
+		int set = 0;
+		for( int y = 0; y < 240; ++y )
+			for( int x = 0; x < 320; ++x )
+				set += is_set_( surface, x, y );
+
+		REQUIRE( 0 == set );
+	}
+}
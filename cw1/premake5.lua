@@ -251,7 +251,11 @@ project "lines-benchmark"
 		"lines-benchmark/**.cpp",
 		"lines-benchmark/**.hpp",
 		"lines-benchmark/**.hxx",
-		"lines-benchmark/**.inl"
+		"lines-benchmark/**.inl",
+
+		-- Benchmarks draw the spaceship from main
+		"main/spaceship.cpp",
+		"main/spaceship.hpp"
 	}
 
 	kind "ConsoleApp"
@@ -264,4 +268,26 @@ project "lines-benchmark"
 
 	links "x-benchmark"
 
+project "triangles-benchmark"
+	local sources = { 
+		"triangles-benchmark/**.cpp",
+		"triangles-benchmark/**.hpp",
+		"triangles-benchmark/**.hxx",
+		"triangles-benchmark/**.inl",
+
+		-- Benchmarks draw asteroids from main
+		"main/asteroid.cpp",
+		"main/asteroid.hpp"
+	}
+
+	kind "ConsoleApp"
+	location "triangles-benchmark"
+
+	files( sources )
+
+	links "vmlib"
+	links "draw2d"
+
+	links "x-benchmark"
+
 --EOF
@@ -9,6 +9,7 @@
 #include "error.hpp"
 #include "checkpoint.hpp"
 
+#include "../draw2d/storage.hpp"
 #include "../draw2d/surface.hpp"
 
 namespace
@@ -111,7 +112,10 @@ void Context::draw( Surface const& aSurface )
 	glActiveTexture( GL_TEXTURE0 );
 	glBindTexture( GL_TEXTURE_2D, mTexImage );
 
+	// Surface rows may be padded (see SurfacePitch in draw2d/storage.hpp).
+	// The row length is given in pixels.
 	glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, GLint(surface_pitch( aSurface ) / 4) );
 	glTexSubImage2D( GL_TEXTURE_2D,
 		0,
 		0, 0,
@@ -119,6 +123,7 @@ void Context::draw( Surface const& aSurface )
 		GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV,
 		aSurface.get_surface_ptr()
 	);
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
 	OGL_CHECKPOINT_DEBUG();
 
 	// Draw stuff
@@ -0,0 +1,373 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+#include <numbers>
+#include <algorithm>
+
+#include <cmath>
+#include <cstdint>
+
+#include "../draw2d/draw.hpp"
+#include "../draw2d/shape.hpp"
+#include "../draw2d/storage.hpp"
+#include "../draw2d/surface.hpp"
+#include "../draw2d/tiled.hpp"
+
+#include "../main/asteroid.hpp"
+
+#include "../vmlib/mat22.hpp"
+
+/* Triangle workloads
+ *
+ * Each benchmark draws a fixed, seeded set of triangles per iteration, so
+ * runs are comparable. Two rates are reported:
+ *  - "triangles": triangles per second (items_per_second)
+ *  - "pixels": covered pixels per second. For single triangles this is
+ *    estimated from the triangle areas, for fans it is counted.
+ *
+ * All benchmarks run on 1080p and 8K surfaces.
+ */
+
+namespace
+{
+	struct Triangle_
+	{
+		Vec2f p0, p1, p2;
+		ColorF c0, c1, c2;
+	};
+
+	float area_( Triangle_ const& aTri )
+	{
+		return 0.5f * std::abs( cross_product( aTri.p1 - aTri.p0, aTri.p2 - aTri.p0 ) );
+	}
+
+	ColorF random_color_( RNG& aRNG )
+	{
+		std::uniform_real_distribution<float> dist( 0.f, 1.f );
+		return ColorF{ dist( aRNG ), dist( aRNG ), dist( aRNG ) };
+	}
+
+	// Triangles with vertices at distance aSize from a center that lies in
+	// [aMin, aMax). The vertex angles are jittered around an equilateral
+	// triangle.
+	std::vector<Triangle_> make_triangles_( RNG& aRNG, std::size_t aCount, float aSize, Vec2f aMin, Vec2f aMax )
+	{
+		std::uniform_real_distribution<float> px( aMin.x, aMax.x ), py( aMin.y, aMax.y );
+		std::uniform_real_distribution<float> angle( 0.f, 2.f*std::numbers::pi_v<float> );
+		std::uniform_real_distribution<float> jitter( -0.4f, 0.4f );
+
+		std::vector<Triangle_> ret;
+		for( std::size_t i = 0; i < aCount; ++i )
+		{
+			Vec2f const center{ px( aRNG ), py( aRNG ) };
+			float const base = angle( aRNG );
+
+			Vec2f p[3];
+			for( int j = 0; j < 3; ++j )
+			{
+				float const a = base + j * (2.f*std::numbers::pi_v<float>/3.f) + jitter( aRNG );
+				p[j] = center + aSize * Vec2f{ std::cos( a ), std::sin( a ) };
+			}
+
+			ret.emplace_back( Triangle_{ p[0], p[1], p[2], random_color_( aRNG ), random_color_( aRNG ), random_color_( aRNG ) } );
+		}
+
+		return ret;
+	}
+
+	void run_triangles_( benchmark::State& aState, Surface& aSurface, std::vector<Triangle_> const& aTriangles )
+	{
+		double pixels = 0.0;
+		for( auto const& tri : aTriangles )
+			pixels += area_( tri );
+
+		for( auto _ : aState )
+		{
+			for( auto const& tri : aTriangles )
+				draw_triangle_interp( aSurface, tri.p0, tri.p1, tri.p2, tri.c0, tri.c1, tri.c2 );
+
+			benchmark::ClobberMemory();
+		}
+
+		aState.SetItemsProcessed( std::int64_t(aTriangles.size()) * aState.iterations() );
+		aState.counters["pixels"] = benchmark::Counter( pixels * double(aState.iterations()), benchmark::Counter::kIsRate );
+	}
+
+	// Triangles of a given size (range 2: the circumradius in pixels; zero
+	// selects screen-sized triangles) fully inside of the surface.
+	void triangles_sized_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+
+		Surface surface( width, height );
+		surface.clear();
+
+		float const size = 0 != aState.range(2) ? float(aState.range(2)) : 0.5f * float(height);
+		std::size_t const count = std::clamp( std::size_t(200000.f / (size*size)), std::size_t(4), std::size_t(8192) );
+
+		RNG rng( 1234 );
+		auto const triangles = make_triangles_( rng, count, size, Vec2f{ size, size }, Vec2f{ width - size, height - size } );
+
+		run_triangles_( aState, surface, triangles );
+	}
+
+	// Long, thin triangles (slivers). These are mostly empty bounding box.
+	void triangles_slivers_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+
+		Surface surface( width, height );
+		surface.clear();
+
+		RNG rng( 2345 );
+		std::uniform_real_distribution<float> px( 0.f, float(width) ), py( 0.f, float(height) );
+		std::uniform_real_distribution<float> thickness( 0.5f, 3.f );
+
+		std::vector<Triangle_> triangles;
+		for( std::size_t i = 0; i < 512; ++i )
+		{
+			Vec2f const a{ px( rng ), py( rng ) };
+			Vec2f const b{ px( rng ), py( rng ) };
+
+			// Offset the third vertex perpendicular to the long edge
+			Vec2f const d = b - a;
+			float const len = length( d );
+			Vec2f const n = (thickness( rng ) / std::max( len, 1.f )) * Vec2f{ -d.y, d.x };
+
+			triangles.emplace_back( Triangle_{ a, b, 0.5f*(a+b) + n, random_color_( rng ), random_color_( rng ), random_color_( rng ) } );
+		}
+
+		run_triangles_( aState, surface, triangles );
+	}
+
+	// Medium sized triangles centered on the borders of the surface; about
+	// half of each is off-screen.
+	void triangles_offscreen_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+
+		Surface surface( width, height );
+		surface.clear();
+
+		float const w = float(width), h = float(height);
+
+		RNG rng( 3456 );
+		std::vector<Triangle_> triangles;
+		for( auto const& [min, max] : { 
+			std::pair{ Vec2f{ 0.f, 0.f }, Vec2f{ w, 0.f } },
+			std::pair{ Vec2f{ 0.f, h }, Vec2f{ w, h } },
+			std::pair{ Vec2f{ 0.f, 0.f }, Vec2f{ 0.f, h } },
+			std::pair{ Vec2f{ w, 0.f }, Vec2f{ w, h } }
+		} )
+		{
+			auto const side = make_triangles_( rng, 64, 64.f, min, Vec2f{ max.x + 1e-3f, max.y + 1e-3f } );
+			triangles.insert( triangles.end(), side.begin(), side.end() );
+		}
+
+		// Roughly half of each triangle is visible
+		double pixels = 0.0;
+		for( auto const& tri : triangles )
+			pixels += 0.5 * area_( tri );
+
+		for( auto _ : aState )
+		{
+			for( auto const& tri : triangles )
+				draw_triangle_interp( surface, tri.p0, tri.p1, tri.p2, tri.c0, tri.c1, tri.c2 );
+
+			benchmark::ClobberMemory();
+		}
+
+		aState.SetItemsProcessed( std::int64_t(triangles.size()) * aState.iterations() );
+		aState.counters["pixels"] = benchmark::Counter( pixels * double(aState.iterations()), benchmark::Counter::kIsRate );
+	}
+
+	// Asteroids from make_asteroid(), as drawn by main. Range 2 is the number
+	// of asteroids.
+	void triangles_asteroid_fans_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+		auto const count = std::size_t(aState.range(2));
+
+		Surface surface( width, height );
+		surface.clear();
+
+		struct Instance
+		{
+			Mat22f rotation;
+			Vec2f position;
+		};
+
+		RNG rng( 4567 );
+		std::uniform_real_distribution<float> px( 0.f, float(width) ), py( 0.f, float(height) );
+		std::uniform_real_distribution<float> angle( 0.f, 2.f*std::numbers::pi_v<float> );
+
+		std::vector<TriangleFan> fans;
+		std::vector<Instance> instances;
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			fans.emplace_back( make_asteroid( rng ) );
+			instances.emplace_back( Instance{ make_rotation_2d( angle( rng ) ), Vec2f{ px( rng ), py( rng ) } } );
+		}
+
+		// Count the covered pixels by drawing each fan once onto a small
+		// scratch surface. Asteroid colors are never black.
+		Surface scratch( 256, 256 );
+
+		std::size_t pixels = 0;
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			scratch.clear();
+			fans[i].draw( scratch, instances[i].rotation, Vec2f{ 128.f, 128.f } );
+
+			for( Surface::Index y = 0; y < 256; ++y )
+			{
+				std::uint8_t const* ptr = surface_row_ptr( scratch, y );
+				for( std::size_t j = 0; j < 256; ++j )
+					pixels += (ptr[4*j+0] | ptr[4*j+1] | ptr[4*j+2]) ? 1 : 0;
+			}
+		}
+
+		for( auto _ : aState )
+		{
+			for( std::size_t i = 0; i < count; ++i )
+				fans[i].draw( surface, instances[i].rotation, instances[i].position );
+
+			benchmark::ClobberMemory();
+		}
+
+		// make_asteroid() creates fans with 18 triangles by default
+		aState.SetItemsProcessed( std::int64_t(count) * 18 * aState.iterations() );
+		aState.counters["pixels"] = benchmark::Counter( double(pixels) * double(aState.iterations()), benchmark::Counter::kIsRate );
+	}
+
+	enum class Layout_
+	{
+		linear, // Surface
+		tiled, // TiledSurface, drawing only
+		detiled // TiledSurface, followed by detile() to a Surface
+	};
+
+	// An asteroid field, drawn to the linear and the tiled layouts. Range 2
+	// is the number of asteroids, range 3 the layout (Layout_). "detiled"
+	// includes the conversion that is needed before the frame can be shown.
+	void triangles_asteroid_layout_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+		auto const count = std::size_t(aState.range(2));
+		auto const layout = Layout_(aState.range(3));
+
+		RNG rng( 4567 );
+		std::uniform_real_distribution<float> px( 0.f, float(width) ), py( 0.f, float(height) );
+		std::uniform_real_distribution<float> angle( 0.f, 2.f*std::numbers::pi_v<float> );
+
+		std::vector<TriangleFan> fans;
+		std::vector<Mat22f> rotations;
+		std::vector<Vec2f> positions;
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			fans.emplace_back( make_asteroid( rng ) );
+			rotations.emplace_back( make_rotation_2d( angle( rng ) ) );
+			positions.emplace_back( Vec2f{ px( rng ), py( rng ) } );
+		}
+
+		Surface surface( width, height );
+		surface.clear();
+
+		TiledSurface tiled( width, height );
+		tiled.clear();
+
+		for( auto _ : aState )
+		{
+			if( Layout_::linear == layout )
+			{
+				for( std::size_t i = 0; i < count; ++i )
+					fans[i].draw( surface, rotations[i], positions[i] );
+			}
+			else
+			{
+				for( std::size_t i = 0; i < count; ++i )
+					draw_triangle_fan( tiled, fans[i], rotations[i], positions[i] );
+
+				if( Layout_::detiled == layout )
+					detile( surface, tiled );
+			}
+
+			benchmark::ClobberMemory();
+		}
+
+		char const* const labels[] = { "linear", "tiled", "tiled + detile" };
+		aState.SetLabel( labels[int(layout)] );
+
+		aState.SetItemsProcessed( std::int64_t(count) * 18 * aState.iterations() );
+	}
+
+	// detile() on its own. Reported as bytes written per second.
+	void triangles_detile_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+
+		Surface surface( width, height );
+		surface.clear();
+
+		TiledSurface tiled( width, height );
+		tiled.fill( { 10, 20, 30 } );
+
+		for( auto _ : aState )
+		{
+			detile( surface, tiled );
+			benchmark::ClobberMemory();
+		}
+
+		aState.SetBytesProcessed( std::int64_t(width) * height * 4 * aState.iterations() );
+	}
+}
+
+BENCHMARK( triangles_sized_ )
+	->ArgNames( { "w", "h", "size" } )
+	->Args( { 1920, 1080, 4 } )
+	->Args( { 7680, 4320, 4 } )
+	->Args( { 1920, 1080, 64 } )
+	->Args( { 7680, 4320, 64 } )
+	->Args( { 1920, 1080, 0 } )
+	->Args( { 7680, 4320, 0 } )
+;
+
+BENCHMARK( triangles_slivers_ )
+	->ArgNames( { "w", "h" } )
+	->Args( { 1920, 1080 } )
+	->Args( { 7680, 4320 } )
+;
+
+BENCHMARK( triangles_offscreen_ )
+	->ArgNames( { "w", "h" } )
+	->Args( { 1920, 1080 } )
+	->Args( { 7680, 4320 } )
+;
+
+BENCHMARK( triangles_asteroid_fans_ )
+	->ArgNames( { "w", "h", "count" } )
+	->Args( { 1920, 1080, 64 } )
+	->Args( { 7680, 4320, 64 } )
+	->Args( { 7680, 4320, 1024 } )
+;
+
+BENCHMARK( triangles_asteroid_layout_ )
+	->ArgNames( { "w", "h", "count", "layout" } )
+	->ArgsProduct( { { 1920 }, { 1080 }, { 1024 }, { 0, 1, 2 } } )
+	->ArgsProduct( { { 7680 }, { 4320 }, { 1024, 16384 }, { 0, 1, 2 } } )
+;
+
+BENCHMARK( triangles_detile_ )
+	->ArgNames( { "w", "h" } )
+	->Args( { 1920, 1080 } )
+	->Args( { 7680, 4320 } )
+;
+
+BENCHMARK_MAIN();
@@ -0,0 +1,120 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <numbers>
+#include <algorithm>
+
+#include "../draw2d/draw.hpp"
+#include "../draw2d/shape.hpp"
+#include "../draw2d/storage.hpp"
+#include "../draw2d/surface.hpp"
+
+namespace
+{
+	int max_difference_( Surface const& aA, Surface const& aB )
+	{
+		auto const bytes = surface_pitch( aA ) * aA.get_height();
+
+		int diff = 0;
+		for( std::size_t i = 0; i < bytes; ++i )
+			diff = std::max( diff, std::abs( int(aA.get_surface_ptr()[i]) - int(aB.get_surface_ptr()[i]) ) );
+
+		return diff;
+	}
+
+	// Reference: draw the triangles of the fan one by one
+	void draw_fan_reference_( Surface& aSurface, std::vector<Vec2f> const& aVerts, std::vector<ColorF> const& aColors, Mat22f const& aRotation, Vec2f aTranslation )
+	{
+		std::size_t const count = aVerts.size();
+		for( std::size_t i = 1; i < count; ++i )
+		{
+			std::size_t const j = i+1 < count ? i+1 : 1;
+			draw_triangle_interp( aSurface,
+				aRotation * aVerts[0] + aTranslation,
+				aRotation * aVerts[i] + aTranslation,
+				aRotation * aVerts[j] + aTranslation,
+				aColors[0], aColors[i], aColors[j]
+			);
+		}
+	}
+}
+
+TEST_CASE( "Triangle fans", "[fan]" )
+{
+	// TriangleFan::draw() rasterizes the fan in one pass. The result must
+	// match drawing the individual triangles in order. Single-colored fans
+	// must be identical. Otherwise, the fan transforms precomputed color
+	// gradients, which may round differently, so allow a difference of one.
+	std::minstd_rand rng( 44 );
+	std::uniform_real_distribution<float> unit( 0.f, 1.f );
+	std::uniform_real_distribution<float> pos( -60.f, 380.f );
+
+	Surface reference( 320, 240 ), other( 320, 240 );
+
+	auto const check = [&] (std::vector<Vec2f> const& aVerts, std::vector<ColorF> const& aColors) {
+		Mat22f const rotation = make_rotation_2d( 2.f * std::numbers::pi_v<float> * unit( rng ) );
+		Vec2f const translation{ pos( rng ), pos( rng ) };
+
+		reference.clear();
+		draw_fan_reference_( reference, aVerts, aColors, rotation, translation );
+
+		other.clear();
+		TriangleFan( aVerts.size(), aVerts.data(), aColors.data() ).draw( other, rotation, translation );
+
+		bool const uniform = std::all_of( aColors.begin(), aColors.end(), [&] (ColorF const& aColor) {
+			return aColor.r == aColors[0].r && aColor.g == aColors[0].g && aColor.b == aColors[0].b;
+		} );
+
+		REQUIRE( max_difference_( reference, other ) <= (uniform ? 0 : 1) );
+	};
+
+	SECTION( "star-shaped" )
+	{
+		// Similar to the asteroids: points around the central vertex, with
+		// increasing angles and random radii.
+		for( int i = 0; i < 100; ++i )
+		{
+			std::size_t const count = 4 + std::size_t(unit( rng ) * 16.f);
+			bool const uniform = unit( rng ) < 0.5f;
+
+			std::vector<Vec2f> verts{ { 0.f, 0.f } };
+			for( std::size_t j = 1; j < count; ++j )
+			{
+				float const angle = 2.f * std::numbers::pi_v<float> * (float(j) + 0.5f*unit( rng )) / float(count-1);
+				float const radius = 20.f + 80.f * unit( rng );
+				verts.emplace_back( Vec2f{ radius * std::cos( angle ), radius * std::sin( angle ) } );
+			}
+
+			ColorF const base{ unit( rng ), unit( rng ), unit( rng ) };
+			std::vector<ColorF> colors;
+			for( std::size_t j = 0; j < count; ++j )
+				colors.emplace_back( uniform ? base : ColorF{ unit( rng ), unit( rng ), unit( rng ) } );
+
+			check( verts, colors );
+		}
+	}
+
+	SECTION( "overlapping" )
+	{
+		// Arbitrary vertices. The triangles overlap, so the order in which
+		// they are drawn matters.
+		std::uniform_real_distribution<float> offset( -120.f, 120.f );
+		for( int i = 0; i < 100; ++i )
+		{
+			std::size_t const count = 3 + std::size_t(unit( rng ) * 8.f);
+
+			std::vector<Vec2f> verts;
+			std::vector<ColorF> colors;
+			for( std::size_t j = 0; j < count; ++j )
+			{
+				verts.emplace_back( Vec2f{ offset( rng ), offset( rng ) } );
+				colors.emplace_back( ColorF{ unit( rng ), unit( rng ), unit( rng ) } );
+			}
+
+			check( verts, colors );
+		}
+	}
+}
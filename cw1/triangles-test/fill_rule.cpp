@@ -0,0 +1,72 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cstddef>
+
+#include "../draw2d/storage.hpp"
+#include "../draw2d/surface.hpp"
+#include "../draw2d/draw.hpp"
+
+namespace
+{
+	bool is_set_( Surface const& aSurface, std::uint32_t aX, std::uint32_t aY )
+	{
+		auto const ptr = surface_row_ptr( aSurface, aY ) + (aX<<2);
+		return ptr[0] > 0 || ptr[1] > 0 || ptr[2] > 0;
+	}
+
+	std::size_t count_overlap_( Surface const& aA, Surface const& aB )
+	{
+		std::size_t overlap = 0;
+		for( std::uint32_t y = 0; y < aA.get_height(); ++y )
+		{
+			for( std::uint32_t x = 0; x < aA.get_width(); ++x )
+			{
+				if( is_set_( aA, x, y ) && is_set_( aB, x, y ) )
+					++overlap;
+			}
+		}
+		return overlap;
+	}
+}
+
+TEST_CASE( "Shared edges", "[fill]" )
+{
+	// Two triangles that share an edge should cover each pixel on the edge
+	// exactly once: there should be neither overlaps nor holes.
+	Surface a( 64, 64 ), b( 64, 64 );
+	a.clear();
+	b.clear();
+
+	ColorF const col{ 1.f, 1.f, 1.f };
+
+	SECTION( "diagonal" )
+	{
+		// A square split along its diagonal. Pixel centers on the diagonal lie
+		// exactly on the shared edge.
+		Vec2f const p0{ 8.f, 8.f }, p1{ 56.f, 8.f }, p2{ 56.f, 56.f }, p3{ 8.f, 56.f };
+
+		draw_triangle_interp( a, p0, p1, p2, col, col, col );
+		draw_triangle_interp( b, p0, p2, p3, col, col, col );
+
+		REQUIRE( 0 == count_overlap_( a, b ) );
+
+		for( std::uint32_t y = 8; y < 56; ++y )
+		{
+			for( std::uint32_t x = 8; x < 56; ++x )
+				REQUIRE( (is_set_( a, x, y ) || is_set_( b, x, y )) );
+		}
+	}
+	SECTION( "vertical" )
+	{
+		// Pixel centers in column 32 lie exactly on the shared edge
+		Vec2f const p0{ 8.5f, 8.f }, p1{ 32.5f, 8.f }, p2{ 32.5f, 56.f }, p3{ 56.5f, 32.f };
+
+		draw_triangle_interp( a, p0, p1, p2, col, col, col );
+		draw_triangle_interp( b, p1, p3, p2, col, col, col );
+
+		REQUIRE( 0 == count_overlap_( a, b ) );
+
+		for( std::uint32_t y = 9; y < 55; ++y )
+			REQUIRE( (is_set_( a, 32, y ) || is_set_( b, 32, y )) );
+	}
+}
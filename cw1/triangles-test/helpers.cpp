@@ -1,6 +1,7 @@
 #include "helpers.hpp"
 
 #include "../draw2d/color.hpp"
+#include "../draw2d/storage.hpp"
 #include "../draw2d/surface.hpp"
 
 
@@ -8,7 +9,7 @@ ColorU8_sRGB find_most_red_pixel( Surface const& aSurface )
 {
 	ColorU8_sRGB ret{ 0, 0, 0 };
 
-	auto const stride = aSurface.get_width() << 2;
+	auto const stride = surface_pitch( aSurface ); // rows may be padded
 	for( std::uint32_t x = 0; x < aSurface.get_width(); ++x )
 	{
 		for( std::uint32_t y = 0; y < aSurface.get_height(); ++y )
@@ -35,7 +36,7 @@ ColorU8_sRGB find_least_red_nonzero_pixel( Surface const& aSurface )
 {
 	ColorU8_sRGB ret{ 255, 255, 255 };
 
-	auto const stride = aSurface.get_width() << 2;
+	auto const stride = surface_pitch( aSurface ); // rows may be padded
 	for( std::uint32_t x = 0; x < aSurface.get_width(); ++x )
 	{
 		for( std::uint32_t y = 0; y < aSurface.get_height(); ++y )
@@ -1,5 +1,6 @@
 #include <catch2/catch_amalgamated.hpp>
 
+#include "../draw2d/storage.hpp"
 #include "../draw2d/surface.hpp"
 #include "../draw2d/draw.hpp"
 #include "helpers.hpp"
@@ -19,7 +20,7 @@ static void same_buffer (Surface& S0, Surface& S1) {
 
     const std::uint8_t* p_0 = S0.get_surface_ptr();
     const std::uint8_t* p_1 = S1.get_surface_ptr();
-    const int bytes = (int)S0.get_width() * (int)(S0.get_height()) * 4;
+    const int bytes = (int)surface_pitch(S0) * (int)(S0.get_height());
     REQUIRE(std::equal(p_0, p_0 + bytes, p_1));
     reset(S0);
     reset(S1);
@@ -1,5 +1,12 @@
 #include <catch2/catch_amalgamated.hpp>
 
+#include <bit>
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <random>
+#include <algorithm>
+
 #include "helpers.hpp"
 
 #include "../draw2d/surface.hpp"
@@ -9,8 +16,8 @@
 
 TEST_CASE( "sRGB conversion", "[interp][sRGB]" )
 {
-#	if DRAW2D_CFG_SRGB_MODE != DRAW2D_CFG_SRGB_EXACT
-#		error "These tests require SRGB_MODE == SRGB_EXACT"
+#	if DRAW2D_CFG_SRGB_MODE != DRAW2D_CFG_SRGB_EXACT && DRAW2D_CFG_SRGB_MODE != DRAW2D_CFG_SRGB_LUT
+#		error "These tests require SRGB_MODE == SRGB_EXACT or SRGB_LUT"
 #	endif
 	
 	Surface surface( 16, 16 );
@@ -49,3 +56,99 @@ TEST_CASE( "sRGB conversion", "[interp][sRGB]" )
 		REQUIRE( 192 == int(col.b) );
 	}
 }
+
+TEST_CASE( "sRGB lookup tables", "[sRGB]" )
+{
+	SrgbTables const& tables = srgb_tables();
+
+	SECTION( "encode" )
+	{
+		// Checking every float in [0,1] takes too long in a debug build.
+		// Instead, check the floats around each step of the encoding, plus
+		// a sparse sample of everything else.
+		for( int k = 1; k < 256; ++k )
+		{
+			float const t = tables.threshold[k];
+			REQUIRE( k == int(linear_to_srgb_exact( t )) );
+			REQUIRE( k-1 == int(linear_to_srgb_exact( std::nextafter( t, 0.f ) )) );
+
+			float v = t;
+			for( int i = 0; i < 16; ++i )
+				v = std::nextafter( v, 0.f );
+
+			for( int i = 0; i < 32; ++i, v = std::nextafter( v, 1.f ) )
+				REQUIRE( linear_to_srgb_exact( v ) == linear_to_srgb( v ) );
+		}
+
+		for( std::uint32_t bits = 0; bits <= std::bit_cast<std::uint32_t>( 1.f ); bits += 4099 )
+		{
+			float const v = std::bit_cast<float>( bits );
+			REQUIRE( linear_to_srgb_exact( v ) == linear_to_srgb( v ) );
+		}
+
+		REQUIRE( 255 == int(linear_to_srgb( 1.f )) );
+	}
+
+#	if DRAW2D_CFG_SRGB_MODE == DRAW2D_CFG_SRGB_LUT
+	SECTION( "out of range" )
+	{
+		// Values outside of [0,1] saturate; NaN encodes as black. (The
+		// exact conversion does not handle these.)
+		REQUIRE( 0 == int(linear_to_srgb( -0.001f )) );
+		REQUIRE( 0 == int(linear_to_srgb( -1.f )) );
+		REQUIRE( 0 == int(linear_to_srgb( -std::numeric_limits<float>::infinity() )) );
+		REQUIRE( 0 == int(linear_to_srgb( std::numeric_limits<float>::quiet_NaN() )) );
+
+		REQUIRE( 255 == int(linear_to_srgb( std::nextafter( 1.f, 2.f ) )) );
+		REQUIRE( 255 == int(linear_to_srgb( 1.5f )) );
+		REQUIRE( 255 == int(linear_to_srgb( std::numeric_limits<float>::infinity() )) );
+	}
+#	endif // ~ SRGB_LUT
+
+	SECTION( "decode" )
+	{
+		for( int i = 0; i < 256; ++i )
+			REQUIRE( linear_from_srgb_exact( std::uint8_t(i) ) == linear_from_srgb( std::uint8_t(i) ) );
+	}
+}
+
+TEST_CASE( "sRGB batch conversion", "[sRGB]" )
+{
+	// Odd count, so that the tail handling in the batch functions is used
+	std::size_t const count = 1001;
+
+	std::minstd_rand rng( 7 );
+	std::uniform_real_distribution<float> dist( -0.1f, 1.1f );
+
+	std::vector<ColorF> colors( count );
+	for( auto& col : colors )
+		col = ColorF{ dist( rng ), dist( rng ), dist( rng ) };
+
+	std::vector<std::uint8_t> rgbx( 4*count );
+	linear_to_srgb( count, colors.data(), rgbx.data() );
+
+	for( std::size_t i = 0; i < count; ++i )
+	{
+		ColorU8_sRGB const ref = linear_to_srgb( ColorF{
+			std::clamp( colors[i].r, 0.f, 1.f ),
+			std::clamp( colors[i].g, 0.f, 1.f ),
+			std::clamp( colors[i].b, 0.f, 1.f )
+		} );
+
+		REQUIRE( ref.r == rgbx[4*i+0] );
+		REQUIRE( ref.g == rgbx[4*i+1] );
+		REQUIRE( ref.b == rgbx[4*i+2] );
+		REQUIRE( 0 == rgbx[4*i+3] );
+	}
+
+	std::vector<ColorF> decoded( count );
+	linear_from_srgb( count, rgbx.data(), decoded.data() );
+
+	for( std::size_t i = 0; i < count; ++i )
+	{
+		ColorF const ref = linear_from_srgb( ColorU8_sRGB{ rgbx[4*i+0], rgbx[4*i+1], rgbx[4*i+2] } );
+		REQUIRE( ref.r == decoded[i].r );
+		REQUIRE( ref.g == decoded[i].g );
+		REQUIRE( ref.b == decoded[i].b );
+	}
+}
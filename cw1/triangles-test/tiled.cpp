@@ -0,0 +1,138 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <numbers>
+
+#include <cstring>
+
+#include "../draw2d/shape.hpp"
+#include "../draw2d/tiled.hpp"
+#include "../draw2d/storage.hpp"
+#include "../draw2d/surface.hpp"
+
+namespace
+{
+	// Number of image pixels that differ (the padding of the rows, if any,
+	// is ignored)
+	std::size_t count_different_( Surface& aA, Surface& aB )
+	{
+		std::size_t different = 0;
+		for( Surface::Index y = 0; y < aA.get_height(); ++y )
+		{
+			std::uint8_t const* a = surface_row_ptr( aA, y );
+			std::uint8_t const* b = surface_row_ptr( aB, y );
+			different += 0 != std::memcmp( a, b, 4*std::size_t(aA.get_width()) );
+		}
+
+		return different;
+	}
+}
+
+TEST_CASE( "Tiled surfaces", "[tiled]" )
+{
+	SECTION( "layout and detile" )
+	{
+		// Partial tiles at the right and top edges
+		TiledSurface tiled( 21, 13 );
+		REQUIRE( 3 == tiled.get_tiles_x() );
+		REQUIRE( 2 == tiled.get_tiles_y() );
+
+		// Tiles are 64 pixels, in row-major order. Strips of tiles may be
+		// padded (see SurfacePitch).
+		std::size_t const strip = pixel_pitch( tiled.get_surface_ptr() ) / 4;
+		REQUIRE( strip >= 3*64 );
+
+		REQUIRE( 0 == tiled.get_linear_index( 0, 0 ) );
+		REQUIRE( 7 == tiled.get_linear_index( 7, 0 ) );
+		REQUIRE( 8 == tiled.get_linear_index( 0, 1 ) );
+		REQUIRE( 64 + 8*2 + 1 == tiled.get_linear_index( 9, 2 ) );
+		REQUIRE( strip + 2*64 + 8*4 + 4 == tiled.get_linear_index( 20, 12 ) );
+
+		tiled.fill( { 200, 200, 200 } );
+		for( TiledSurface::Index y = 0; y < 13; ++y )
+		{
+			for( TiledSurface::Index x = 0; x < 21; ++x )
+				tiled.set_pixel_srgb( x, y, { std::uint8_t(x), std::uint8_t(y), std::uint8_t(x+y) } );
+		}
+
+		Surface linear( 21, 13 );
+		linear.fill( { 1, 2, 3 } );
+		detile( linear, tiled );
+
+		std::size_t wrong = 0;
+		for( Surface::Index y = 0; y < 13; ++y )
+		{
+			std::uint8_t const* row = surface_row_ptr( linear, y );
+			for( Surface::Index x = 0; x < 21; ++x )
+			{
+				wrong += row[4*x+0] != x;
+				wrong += row[4*x+1] != y;
+				wrong += row[4*x+2] != x+y;
+				wrong += row[4*x+3] != 0;
+			}
+		}
+
+		REQUIRE( 0 == wrong );
+	}
+
+	SECTION( "large" )
+	{
+		// 2560x1700 pixels are 17 MB, so detile() streams the output
+		TiledSurface tiled( 2560, 1700 );
+		tiled.fill( { 9, 8, 7 } );
+		tiled.set_pixel_srgb( 2559, 1699, { 1, 2, 3 } );
+
+		Surface linear( 2560, 1700 );
+		linear.clear();
+		detile( linear, tiled );
+
+		REQUIRE( surface_row_ptr( linear, 0 )[0] == 9 );
+		REQUIRE( surface_row_ptr( linear, 850 )[4*1234 + 1] == 8 );
+		REQUIRE( surface_row_ptr( linear, 1699 )[4*2558 + 2] == 7 );
+		REQUIRE( surface_row_ptr( linear, 1699 )[4*2559 + 2] == 3 );
+	}
+
+	SECTION( "fans" )
+	{
+		// Drawing to a tiled surface and detiling produces exactly the same
+		// image as drawing to a regular surface.
+		std::minstd_rand rng( 45 );
+		std::uniform_real_distribution<float> unit( 0.f, 1.f );
+		std::uniform_real_distribution<float> pos( -60.f, 380.f );
+
+		Surface reference( 317, 243 ), detiled( 317, 243 );
+		TiledSurface tiled( 317, 243 );
+
+		reference.clear();
+		tiled.clear();
+
+		for( int i = 0; i < 100; ++i )
+		{
+			std::size_t const count = 4 + std::size_t(unit( rng ) * 16.f);
+			bool const uniform = unit( rng ) < 0.5f;
+
+			std::vector<Vec2f> verts{ { 0.f, 0.f } };
+			std::vector<ColorF> colors{ { unit( rng ), unit( rng ), unit( rng ) } };
+			for( std::size_t j = 1; j < count; ++j )
+			{
+				float const angle = 2.f * std::numbers::pi_v<float> * (float(j) + 0.5f*unit( rng )) / float(count-1);
+				float const radius = 5.f + 60.f * unit( rng );
+				verts.emplace_back( Vec2f{ radius * std::cos( angle ), radius * std::sin( angle ) } );
+				colors.emplace_back( uniform ? colors[0] : ColorF{ unit( rng ), unit( rng ), unit( rng ) } );
+			}
+
+			TriangleFan const fan( count, verts.data(), colors.data() );
+
+			Mat22f const rotation = make_rotation_2d( 2.f * std::numbers::pi_v<float> * unit( rng ) );
+			Vec2f const translation{ pos( rng ), pos( rng ) };
+
+			fan.draw( reference, rotation, translation );
+			draw_triangle_fan( tiled, fan, rotation, translation );
+		}
+
+		detile( detiled, tiled );
+		REQUIRE( 0 == count_different_( reference, detiled ) );
+	}
+}
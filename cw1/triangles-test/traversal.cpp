@@ -0,0 +1,105 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <algorithm>
+
+#include "../draw2d/storage.hpp"
+#include "../draw2d/surface.hpp"
+#include "../draw2d/draw.hpp"
+#include "../draw2d/triangle.hpp"
+
+namespace
+{
+	bool same_pixels_( Surface const& aA, Surface const& aB )
+	{
+		auto const bytes = surface_pitch( aA ) * aA.get_height();
+		return std::equal( aA.get_surface_ptr(), aA.get_surface_ptr() + bytes, aB.get_surface_ptr() );
+	}
+}
+
+TEST_CASE( "Traversal modes agree", "[traversal]" )
+{
+	// The different traversals in triangle.hpp must produce identical
+	// results. The triangles here are random, but partially off-screen
+	// triangles and slivers are relatively common with these settings.
+	std::minstd_rand rng( 42 );
+	std::uniform_real_distribution<float> pos( -80.f, 400.f );
+	std::uniform_real_distribution<float> col( 0.f, 1.f );
+
+	Surface reference( 320, 240 ), other( 320, 240 );
+
+	for( int i = 0; i < 500; ++i )
+	{
+		Vec2f const p0{ pos( rng ), pos( rng ) };
+		Vec2f const p1{ pos( rng ), pos( rng ) };
+		Vec2f const p2{ pos( rng ), pos( rng ) };
+
+		ColorF const c0{ col( rng ), col( rng ), col( rng ) };
+		ColorF const c1{ col( rng ), col( rng ), col( rng ) };
+		ColorF const c2{ col( rng ), col( rng ), col( rng ) };
+
+		TriangleSetup setup;
+		if( !setup_triangle( setup, reference, p0, p1, p2, c0, c1, c2 ) )
+			continue;
+
+		reference.clear();
+		rasterize_triangle_edges( reference, setup );
+
+		other.clear();
+		rasterize_triangle_spans( other, setup );
+		REQUIRE( same_pixels_( reference, other ) );
+
+		other.clear();
+		rasterize_triangle_blocks( other, setup );
+		REQUIRE( same_pixels_( reference, other ) );
+
+#		if DRAW2D_CFG_ENABLE_AVX2
+		if( cpu_has_avx2() )
+		{
+			other.clear();
+			rasterize_triangle_edges_avx2( other, setup );
+			REQUIRE( same_pixels_( reference, other ) );
+
+			other.clear();
+			rasterize_triangle_spans_avx2( other, setup );
+			REQUIRE( same_pixels_( reference, other ) );
+
+			other.clear();
+			rasterize_triangle_blocks_avx2( other, setup );
+			REQUIRE( same_pixels_( reference, other ) );
+		}
+#		endif // ~ ENABLE_AVX2
+	}
+}
+
+TEST_CASE( "Solid fill matches interpolation", "[traversal][solid]" )
+{
+	// rasterize_triangle_solid() must cover the same pixels as the
+	// interpolating traversals, and give the same color when the vertex
+	// colors are all identical.
+	std::minstd_rand rng( 43 );
+	std::uniform_real_distribution<float> pos( -80.f, 400.f );
+	std::uniform_real_distribution<float> col( 0.f, 1.f );
+
+	Surface reference( 320, 240 ), other( 320, 240 );
+
+	for( int i = 0; i < 200; ++i )
+	{
+		Vec2f const p0{ pos( rng ), pos( rng ) };
+		Vec2f const p1{ pos( rng ), pos( rng ) };
+		Vec2f const p2{ pos( rng ), pos( rng ) };
+
+		ColorF const c{ col( rng ), col( rng ), col( rng ) };
+
+		TriangleSetup setup;
+		if( !setup_triangle( setup, reference, p0, p1, p2, c, c, c ) )
+			continue;
+
+		reference.clear();
+		rasterize_triangle_edges( reference, setup );
+
+		other.clear();
+		draw_triangle_solid( other, p0, p1, p2, linear_to_srgb( c ) );
+		REQUIRE( same_pixels_( reference, other ) );
+	}
+}